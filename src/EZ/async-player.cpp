@@ -0,0 +1,230 @@
+#include "async-player.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+#if defined __linux__
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace libsidplayEZ
+{
+
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+AsyncPlayer<sample_t>::AsyncPlayer ( Player& _player, const setup_t& _setup )
+	: player ( _player )
+	, setup ( _setup )
+{
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+AsyncPlayer<sample_t>::~AsyncPlayer ()
+{
+	stop ();
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+void AsyncPlayer<sample_t>::start ()
+{
+	stop ();
+
+	if ( const auto outChannels = player.getNumOutChannels (); outChannels != channels )
+	{
+		channels = outChannels;
+
+		// At least two blocks, so a round finds room while the callback reads
+		const auto	blockFrames = std::max ( setup.blockFrames, 1u );
+		const auto	frames = std::bit_ceil ( std::max ( setup.aheadFrames, 2 * blockFrames ) );
+
+		ring.assign ( size_t ( frames ) * unsigned ( channels ), sample_t ( 0 ) );
+		mask = uint32_t ( ring.size () ) - 1;
+		block = blockFrames * uint32_t ( channels );
+
+		writePos = 0;
+		dropPos = 0;
+		readPos = 0;
+	}
+
+	// At most one ring's worth, however fast the callback reads meanwhile
+	for ( auto rounds = ring.size () / block; rounds && fill (); rounds-- );
+
+	thread = std::jthread ( [ this ] ( std::stop_token stop ) { work ( stop ); } );
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+void AsyncPlayer<sample_t>::stop ()
+{
+	if ( ! thread.joinable () )
+		return;
+
+	thread.request_stop ();
+	thread.join ();
+
+	// The reader owns its position, it skips what is left on its own
+	dropPos.store ( writePos.load ( std::memory_order_relaxed ) );
+
+	// A read which missed the drop may still copy the frames dropped, which count as free from now on
+	if ( const auto pending = reads.load (); pending & 1 )
+		while ( reads.load ( std::memory_order_acquire ) == pending )
+			std::this_thread::yield ();
+
+	realtime = false;
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+uint32_t AsyncPlayer<sample_t>::read ( sample_t* buffer, uint32_t frames )
+{
+	// Nothing to read before the first start
+	if ( ring.empty () )
+		return 0;
+
+	reads.fetch_add ( 1 );
+
+	const auto	wanted = frames * uint32_t ( channels );
+	auto		read = readPos.load ( std::memory_order_relaxed );
+
+	// Skip the frames dropped when stopping
+	if ( const auto drop = dropPos.load (); int32_t ( drop - read ) > 0 )
+		read = drop;
+
+	const auto	count = std::min ( writePos.load ( std::memory_order_acquire ) - read, wanted );
+	const auto	offset = read & mask;
+	const auto	first = std::min ( count, uint32_t ( ring.size () ) - offset );
+
+	std::copy_n ( ring.data () + offset, first, buffer );
+	std::copy_n ( ring.data (), count - first, buffer + first );
+
+	readPos.store ( read + count, std::memory_order_release );
+	reads.fetch_add ( 1, std::memory_order_release );
+
+	if ( count < wanted )
+	{
+		std::fill_n ( buffer + count, wanted - count, sample_t ( 0 ) );
+		underruns.fetch_add ( 1, std::memory_order_relaxed );
+	}
+
+	return count / uint32_t ( channels );
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+typename AsyncPlayer<sample_t>::stats_t AsyncPlayer<sample_t>::getStats () const
+{
+	stats_t	stats;
+
+	stats.underruns = underruns.load ( std::memory_order_relaxed );
+	stats.overruns = overruns.load ( std::memory_order_relaxed );
+	if ( channels )
+	{
+		const auto	write = writePos.load ( std::memory_order_acquire );
+		stats.buffered = ( write - readFrom () ) / uint32_t ( channels );
+	}
+
+	stats.realtime = realtime;
+
+	return stats;
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+void AsyncPlayer<sample_t>::resetStats ()
+{
+	underruns = 0;
+	overruns = 0;
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+uint32_t AsyncPlayer<sample_t>::readFrom () const
+{
+	const auto	read = readPos.load ( std::memory_order_acquire );
+	const auto	drop = dropPos.load ( std::memory_order_acquire );
+
+	// The reader skips to the drop position on its next read, the frames before are free already
+	return int32_t ( drop - read ) > 0 ? drop : read;
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+bool AsyncPlayer<sample_t>::fill ()
+{
+	const auto	write = writePos.load ( std::memory_order_relaxed );
+	const auto	space = uint32_t ( ring.size () ) - ( write - readFrom () );
+
+	// Play takes any count, so render straight into the ring up to its end
+	const auto	offset = write & mask;
+	const auto	count = std::min ( { space, block, uint32_t ( ring.size () ) - offset } );
+
+	if ( count == 0 )
+		return false;
+
+	const auto	start = std::chrono::steady_clock::now ();
+	const auto	rendered = player.runEmulation ( ring.data () + offset, count );
+	const auto	elapsed = std::chrono::duration<double> ( std::chrono::steady_clock::now () - start ).count ();
+
+	if ( rendered == 0 )
+		return false;
+
+	if ( elapsed * player.getSamplerate () > double ( rendered / uint32_t ( channels ) ) )
+		overruns.fetch_add ( 1, std::memory_order_relaxed );
+
+	writePos.store ( write + rendered, std::memory_order_release );
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+void AsyncPlayer<sample_t>::applyHints ()
+{
+#if defined __linux__
+	const auto	self = pthread_self ();
+
+	if ( setup.cpu >= 0 && setup.cpu < CPU_SETSIZE )
+	{
+		cpu_set_t	cpus;
+		CPU_ZERO ( &cpus );
+		CPU_SET ( setup.cpu, &cpus );
+
+		pthread_setaffinity_np ( self, sizeof ( cpus ), &cpus );
+	}
+
+	if ( setup.priority > 0 )
+	{
+		sched_param	param = {};
+		param.sched_priority = std::clamp ( setup.priority, sched_get_priority_min ( SCHED_FIFO ), sched_get_priority_max ( SCHED_FIFO ) );
+
+		realtime = pthread_setschedparam ( self, SCHED_FIFO, &param ) == 0;
+	}
+#endif
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+void AsyncPlayer<sample_t>::work ( std::stop_token stop )
+{
+	applyHints ();
+
+	// Polled while the ring is full, the reader never signals so it never blocks
+	const auto	pause = std::chrono::duration<double> ( 0.5 * std::max ( setup.blockFrames, 1u ) / std::max ( player.getSamplerate (), 1 ) );
+
+	while ( ! stop.stop_requested () )
+	{
+		if ( ! fill () )
+			std::this_thread::sleep_for ( pause );
+	}
+}
+//-----------------------------------------------------------------------------
+
+template class AsyncPlayer<int16_t>;
+template class AsyncPlayer<float>;
+
+}
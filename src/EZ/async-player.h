@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "player.h"
+
+namespace libsidplayEZ
+{
+//-----------------------------------------------------------------------------
+
+/**
+* Render a Player ahead of playback on a thread of its own, for real-time hosts.
+*
+* The thread keeps a ring of frames filled, which the audio callback copies out
+* with #read. Reading is wait-free, no locks, no allocations and no system calls,
+* so spikes of the emulation, like building the filter tables of the first
+* 6581 or reinitialising the tune, only eat into the frames rendered ahead.
+*
+* The thread owns the player while running. Set up the tune before #start,
+* and #stop for changing it or anything else on the player. The callback may
+* keep reading meanwhile, it gets silence until the new frames are rendered.
+*/
+template<typename sample_t>
+class AsyncPlayer final
+{
+public:
+	struct setup_t final
+	{
+		uint32_t	aheadFrames = 4096;		// Frames rendered ahead at most, rounded up to a power of two
+		uint32_t	blockFrames = 256;		// Frames rendered per round of the thread
+
+		// Hints for the thread, only on Linux. Without the permission to apply them it runs as usual
+		int			priority = 0;			// SCHED_FIFO priority, 0 keeps the default scheduling
+		int			cpu = -1;				// CPU to pin the thread to, -1 for any
+	};
+
+	struct stats_t final
+	{
+		uint64_t	underruns = 0;			// Reads which found fewer frames than asked for, the rest is silence
+		uint64_t	overruns = 0;			// Rounds which took longer to render than to play
+		uint32_t	buffered = 0;			// Frames rendered ahead right now
+		bool		realtime = false;		// The thread runs with SCHED_FIFO
+	};
+
+	AsyncPlayer ( Player& player, const setup_t& setup = {} );
+
+	/**
+	* Stop the thread.
+	*/
+	~AsyncPlayer ();
+
+	AsyncPlayer ( const AsyncPlayer& ) = delete;
+	AsyncPlayer& operator= ( const AsyncPlayer& ) = delete;
+
+	/**
+	* Fill the ring on the calling thread, then start the thread to keep it filled.
+	* The first start, and any with a different number of channels than the last,
+	* sets up the ring and must not run while #read does.
+	*/
+	void start ();
+
+	/**
+	* Stop the thread and drop the frames rendered ahead, the player is free to use again.
+	*/
+	void stop ();
+
+	[[ nodiscard ]] bool isRunning () const { return thread.joinable (); }
+
+	/**
+	* Copy rendered frames out, filling what isn't rendered yet with silence.
+	* Wait-free, meant to be called from the audio callback, by one thread at a time.
+	*
+	* @param buffer output, interleaved when stereo
+	* @param frames number of frames to fill
+	* @return number of frames rendered, the rest is silence. Before the first #start
+	*         the number of channels isn't known yet, the buffer is left alone then
+	*/
+	uint32_t read ( sample_t* buffer, uint32_t frames );
+
+	[[ nodiscard ]] stats_t getStats () const;
+	void resetStats ();
+
+private:
+	Player&			player;
+	const setup_t	setup;
+
+	std::vector<sample_t>	ring;
+	uint32_t				mask = 0;
+	uint32_t				block = 0;		// Samples per round
+	int						channels = 0;
+
+	// Free running positions in samples, on cache lines of their own as each side writes one
+	alignas ( 64 ) std::atomic<uint32_t>	writePos = 0;
+	std::atomic<uint32_t>					dropPos = 0;	// The reader skips everything before, set when stopping
+	alignas ( 64 ) std::atomic<uint32_t>	readPos = 0;
+	std::atomic<uint32_t>					reads = 0;		// Odd while #read copies, for #stop to wait on
+
+	alignas ( 64 ) std::atomic<uint64_t>	underruns = 0;
+	std::atomic<uint64_t>	overruns = 0;
+	std::atomic<bool>		realtime = false;
+
+	std::jthread	thread;
+
+	/**
+	* Render a round into the ring, as much as fits up to a block.
+	*
+	* @return false if the ring is full
+	*/
+	bool fill ();
+
+	/**
+	* Position the reader continues from, past the frames dropped when stopping.
+	*/
+	[[ nodiscard ]] uint32_t readFrom () const;
+
+	void applyHints ();
+	void work ( std::stop_token stop );
+};
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,279 @@
+#include "batch-renderer.h"
+
+#include <algorithm>
+
+namespace libsidplayEZ
+{
+
+//-----------------------------------------------------------------------------
+
+BatchRenderer::BatchRenderer ( const setup_t& _setup, callback _onResult, unsigned int threads, size_t _capacity )
+	: setup ( _setup )
+	, onResult ( std::move ( _onResult ) )
+	, capacity ( _capacity ? _capacity : 4 * std::max ( threads ? threads : std::thread::hardware_concurrency (), 1u ) )
+{
+	if ( ! threads )
+		threads = std::max ( std::thread::hardware_concurrency (), 1u );
+
+	for ( auto i = 0u; i < threads; i++ )
+		workers.emplace_back ( std::make_unique<worker> () );
+
+	// Only start once all queues exist, as the workers steal from each other
+	for ( auto i = size_t ( 0 ); i < workers.size (); i++ )
+		workers[ i ]->thread = std::jthread ( [ this, i ] { work ( i ); } );
+}
+//-----------------------------------------------------------------------------
+
+BatchRenderer::~BatchRenderer ()
+{
+	cancelAll ();
+
+	{
+		std::lock_guard	guard ( lock );
+		stopping = true;
+	}
+	wakeup.notify_all ();
+
+	for ( auto& w : workers )
+		w->thread.join ();
+}
+//-----------------------------------------------------------------------------
+
+uint64_t BatchRenderer::submit ( job_t job )
+{
+	std::unique_lock	guard ( lock );
+	space.wait ( guard, [ this ] { return queued < capacity; } );
+
+	uint64_t	id;
+	enqueue ( std::move ( job ), id );
+
+	return id;
+}
+//-----------------------------------------------------------------------------
+
+bool BatchRenderer::trySubmit ( job_t job, uint64_t& id )
+{
+	std::lock_guard	guard ( lock );
+	if ( queued >= capacity )
+		return false;
+
+	enqueue ( std::move ( job ), id );
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+void BatchRenderer::enqueue ( job_t&& job, uint64_t& id )
+{
+	// Called with the lock held, so a worker woken up finds the job in place
+	id = nextId++;
+
+	auto	t = std::make_shared<task> ();
+	t->id = id;
+	t->job = std::move ( job );
+
+	live.emplace ( id, t );
+	queued++;
+
+	auto&	w = *workers[ nextWorker++ % workers.size () ];
+	{
+		std::lock_guard	guard ( w.lock );
+		w.tasks.push_back ( std::move ( t ) );
+	}
+
+	wakeup.notify_one ();
+}
+//-----------------------------------------------------------------------------
+
+void BatchRenderer::cancel ( uint64_t id )
+{
+	std::lock_guard	guard ( lock );
+
+	if ( const auto it = live.find ( id ); it != live.end () )
+		it->second->canceled = true;
+}
+//-----------------------------------------------------------------------------
+
+void BatchRenderer::cancelAll ()
+{
+	std::lock_guard	guard ( lock );
+
+	for ( auto& [ id, t ] : live )
+		t->canceled = true;
+}
+//-----------------------------------------------------------------------------
+
+void BatchRenderer::wait ()
+{
+	std::unique_lock	guard ( lock );
+	idle.wait ( guard, [ this ] { return live.empty (); } );
+}
+//-----------------------------------------------------------------------------
+
+std::shared_ptr<BatchRenderer::task> BatchRenderer::take ( size_t index )
+{
+	{
+		auto&	w = *workers[ index ];
+
+		std::lock_guard	guard ( w.lock );
+		if ( ! w.tasks.empty () )
+		{
+			auto	t = std::move ( w.tasks.front () );
+			w.tasks.pop_front ();
+			return t;
+		}
+	}
+
+	for ( auto i = size_t ( 1 ); i < workers.size (); i++ )
+	{
+		auto&	w = *workers[ ( index + i ) % workers.size () ];
+
+		std::lock_guard	guard ( w.lock );
+		if ( ! w.tasks.empty () )
+		{
+			auto	t = std::move ( w.tasks.back () );
+			w.tasks.pop_back ();
+			return t;
+		}
+	}
+
+	return nullptr;
+}
+//-----------------------------------------------------------------------------
+
+void BatchRenderer::work ( size_t index )
+{
+	// Warm for the lifetime of the worker
+	Player	player;
+
+	player.setRoms ( setup.kernal, setup.basic, setup.character );
+	player.setStateCacheBudget ( setup.stateCacheBudget );
+
+	if ( ! setup.sidIDConfig.empty () )
+		player.loadSidIDConfig ( setup.sidIDConfig.c_str () );
+
+	if ( ! setup.chipProfiles.empty () )
+		player.setChipProfileMap ( setup.chipProfiles );
+
+	std::string	loadedFile;
+
+	for ( ;; )
+	{
+		auto	t = take ( index );
+
+		if ( ! t )
+		{
+			std::unique_lock	guard ( lock );
+			wakeup.wait ( guard, [ this ] { return stopping || queued > 0; } );
+
+			if ( stopping && queued == 0 )
+				return;
+
+			continue;
+		}
+
+		{
+			std::lock_guard	guard ( lock );
+			queued--;
+		}
+		space.notify_one ();
+
+		result_t	result;
+		result.id = t->id;
+
+		if ( t->canceled )
+			result.status = status_t::CANCELED;
+		else
+			render ( player, loadedFile, *t, result );
+
+		if ( onResult )
+			onResult ( std::move ( result ) );
+
+		{
+			std::lock_guard	guard ( lock );
+			live.erase ( t->id );
+
+			if ( ! live.empty () )
+				continue;
+		}
+		idle.notify_all ();
+	}
+}
+//-----------------------------------------------------------------------------
+
+void BatchRenderer::render ( Player& player, std::string& loadedFile, task& t, result_t& result )
+{
+	const auto&	job = t.job;
+
+	// Further subtunes of the same file keep the tune and its cached states
+	if ( job.filename != loadedFile )
+	{
+		loadedFile.clear ();
+
+		if ( ! player.loadSidFile ( job.filename.c_str () ) )
+		{
+			const auto	status = player.getSidTune ().statusString ();
+
+			result.error = status ? status : "BATCH ERROR: Could not load the tune.";
+			return;
+		}
+
+		loadedFile = job.filename;
+	}
+
+	const auto&	config = job.config;
+
+	player.setSamplerate ( config.sampleRate );
+	player.setSamplingMethod ( config.samplingMethod );
+	player.setForceMono ( config.mono );
+	player.setSidModel ( config.sidModel );
+	player.setChipProfileOverride ( config.chipProfile );
+	player.setSoftClip ( config.softClip );
+
+	if ( ! player.setTuneNumber ( job.song ) )
+	{
+		result.error = player.error ();
+		return;
+	}
+
+	result.channels = player.getNumOutChannels ();
+
+	const auto	total = size_t ( uint64_t ( job.durationMs ) * uint64_t ( config.sampleRate ) / 1000 ) * size_t ( result.channels );
+
+	// Check for cancellation every 100 ms of audio
+	const auto	chunk = size_t ( std::max ( config.sampleRate / 10, 1 ) ) * size_t ( result.channels );
+
+	auto	run = [ & ] ( auto& samples )
+	{
+		samples.resize ( total );
+
+		for ( auto done = size_t ( 0 ); done < total; )
+		{
+			if ( t.canceled )
+			{
+				result.status = status_t::CANCELED;
+				samples.clear ();
+				return false;
+			}
+
+			const auto	count = player.runEmulation ( samples.data () + done, uint32_t ( std::min ( chunk, total - done ) ) );
+			if ( ! count )
+			{
+				result.error = player.error ();
+				samples.clear ();
+				return false;
+			}
+
+			done += count;
+		}
+
+		return true;
+	};
+
+	if ( ! ( config.floatOutput ? run ( result.floatSamples ) : run ( result.samples ) ) )
+		return;
+
+	result.status = status_t::DONE;
+}
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "player.h"
+
+namespace libsidplayEZ
+{
+//-----------------------------------------------------------------------------
+
+/**
+* Render many tunes in parallel, with one Player per worker thread.
+*
+* Every worker queues jobs of its own and steals from the others when it runs dry,
+* so long and short tunes even out. The players stay alive between jobs, keeping
+* their state caches, so further subtunes of a file don't run the init routine again.
+* Each job brings its own output and chip settings, see #config_t.
+*/
+class BatchRenderer final
+{
+public:
+	/**
+	* Set on the player of every worker.
+	*/
+	struct setup_t final
+	{
+		const void*	kernal = nullptr;
+		const void*	basic = nullptr;
+		const void*	character = nullptr;
+
+		std::string					sidIDConfig;		// Empty to skip the player routine detection
+		ChipSelector::profileMap	chipProfiles;		// Empty for the built-in profiles
+
+		size_t	stateCacheBudget = 16 * 1024 * 1024;
+	};
+
+	/**
+	* Set on the player of the worker before each job. Jobs with the same
+	* settings reuse the states cached for each other.
+	*/
+	struct config_t final
+	{
+		int								sampleRate = 44100;
+		SidConfig::sampling_method_t	samplingMethod = SidConfig::RESAMPLE;
+
+		bool	mono = false;			// Mix all chips into one channel
+		bool	floatOutput = false;	// Render into result_t::floatSamples
+		bool	softClip = true;		// Of the float output
+
+		std::optional<SidConfig::sid_model_t>	sidModel;		// Instead of the model of the tune
+		std::optional<ChipSelector::settings>	chipProfile;	// Instead of the profile picked for the tune
+	};
+
+	struct job_t final
+	{
+		std::string		filename;
+		unsigned int	song = 0;			// 0 for the start song
+		uint32_t		durationMs = 0;
+		config_t		config;
+	};
+
+	enum class status_t
+	{
+		DONE,
+		FAILED,
+		CANCELED,
+	};
+
+	struct result_t final
+	{
+		uint64_t	id = 0;
+		status_t	status = status_t::FAILED;
+		std::string	error;					// Why the job failed
+
+		int						channels = 1;
+		std::vector<int16_t>	samples;		// Interleaved when stereo
+		std::vector<float>		floatSamples;	// Instead, with config_t::floatOutput
+	};
+
+	using callback = std::function<void ( result_t&& )>;
+
+	/**
+	* Start the workers.
+	*
+	* @param setup configuration of the players
+	* @param onResult called on the worker threads once per submitted job, in any order
+	* @param threads number of workers, 0 for one per core
+	* @param capacity number of jobs waiting at most before #submit blocks, 0 for 4 per worker
+	*/
+	BatchRenderer ( const setup_t& setup, callback onResult, unsigned int threads = 0, size_t capacity = 0 );
+
+	/**
+	* Cancel the remaining jobs and stop the workers.
+	*/
+	~BatchRenderer ();
+
+	BatchRenderer ( const BatchRenderer& ) = delete;
+	BatchRenderer& operator= ( const BatchRenderer& ) = delete;
+
+	/**
+	* Queue a job, waiting while the queue is full.
+	*
+	* @return the id of the job, as passed back in its result
+	*/
+	uint64_t submit ( job_t job );
+
+	/**
+	* Queue a job unless the queue is full.
+	*
+	* @return false if the queue is full
+	*/
+	bool trySubmit ( job_t job, uint64_t& id );
+
+	/**
+	* Cancel a job, waiting or being rendered. Its result is reported as canceled.
+	*/
+	void cancel ( uint64_t id );
+	void cancelAll ();
+
+	/**
+	* Wait until the results of all submitted jobs are reported.
+	*/
+	void wait ();
+
+	[[ nodiscard ]] unsigned int getNumWorkers () const { return unsigned ( workers.size () ); }
+
+private:
+	struct task final
+	{
+		uint64_t			id;
+		job_t				job;
+		std::atomic<bool>	canceled = false;
+	};
+
+	struct worker final
+	{
+		std::mutex								lock;
+		std::deque<std::shared_ptr<task>>		tasks;
+		std::jthread							thread;
+	};
+
+	const setup_t	setup;
+	const callback	onResult;
+	const size_t	capacity;
+
+	std::vector<std::unique_ptr<worker>>	workers;
+
+	// Guards everything below
+	std::mutex				lock;
+	std::condition_variable	wakeup;		// Jobs queued or stopping
+	std::condition_variable	space;		// Room in the queue
+	std::condition_variable	idle;		// All results reported
+
+	std::unordered_map<uint64_t, std::shared_ptr<task>>	live;	// Submitted and not reported yet
+
+	size_t		queued = 0;
+	uint64_t	nextId = 1;
+	size_t		nextWorker = 0;
+	bool		stopping = false;
+
+	void enqueue ( job_t&& job, uint64_t& id );
+
+	// Own jobs first, oldest first, then the newest of another worker
+	[[ nodiscard ]] std::shared_ptr<task> take ( size_t index );
+
+	void work ( size_t index );
+	void render ( Player& player, std::string& loadedFile, task& t, result_t& result );
+};
+//-----------------------------------------------------------------------------
+
+}
@@ -2,6 +2,7 @@
 
 #include <unordered_map>
 #include <string>
+#include <tuple>
 
 namespace libsidplayEZ
 {
@@ -34,6 +35,13 @@ public:
 		double		cwsThreshold = 0.8;
 
 		std::unordered_map<std::string, std::string>	exceptions;
+
+		// Same settings for the emulation, whatever the folder and exceptions
+		[[ nodiscard ]] bool sameChip ( const settings& other ) const
+		{
+			return std::tie ( fltCox, flt0Dac, fltGain, digi, cwsLevel, cwsThreshold )
+				== std::tie ( other.fltCox, other.flt0Dac, other.fltGain, other.digi, other.cwsLevel, other.cwsThreshold );
+		}
 	};
 
 	using profileMap = std::unordered_map<std::string, settings>;
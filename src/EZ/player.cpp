@@ -14,6 +14,8 @@ void Player::setRoms ( const void* kernal, const void* basic, const void* charac
 	engine.setKernal ( (const uint8_t*)kernal );
 	engine.setBasic ( (const uint8_t*)basic );
 	engine.setChargen ( (const uint8_t*)character );
+
+	stateCache.clear ();
 }
 //-----------------------------------------------------------------------------
 
@@ -29,6 +31,9 @@ bool Player::loadSidFile ( const char* filename )
 	stiEZ = {};
 
 	tune.load ( filename );
+	if ( ! tune.getStatus () )
+		return false;
+
 	stiEZ.md5 = tune.createMD5New ();
 
 	auto	info = tune.getInfo ();
@@ -69,64 +74,38 @@ bool libsidplayEZ::Player::setTuneNumber ( const unsigned int songNo )
 	if ( ! info )
 		return false;
 
-	// Initialize SID engine(s)
-	config.playback = info->sidChips () == 1 ? SidConfig::playback_t::MONO : SidConfig::playback_t::STEREO;
-
-	if ( ! engine.setConfig ( config ) )
-		return false;
-
-	// Load the tune
-	readyToPlay = engine.loadTune ( &tune );
-
-	if ( ! readyToPlay )
-		return false;
-
-	// Fill the info struct for this particular tune
-	{
-		// Model(s)
-		for ( auto i = 0; i < engine.getNumChips (); ++i )
-			stiEZ.model.emplace_back ( info->sidModel ( i ) == SidTuneInfo::model_t::SIDMODEL_8580 ? "8580" : "6581" );
-
-		// Clock
-		stiEZ.clock = info->clockSpeed () == SidTuneInfo::clock_t::CLOCK_NTSC ? "NTSC" : "PAL";
-
-		// Speed
-		const auto& engineInfo = (const SidInfoImpl&)engine.getInfo ();
-
-		stiEZ.speed = engineInfo.speedString ();
-	}
-
 	//
 	// Attempt to have better sounding SIDs by adjusting filter-range, digi-boost, and combined waveform strength
-	// per author with the assumption they worked with the same machine their entire career
+	// per author with the assumption they worked with the same machine their entire career.
+	// Set before loading, so the init routine runs with them too
 	//
+	if ( profileOverride )
+	{
+		stiEZ.chipProfile = "Set by the host";
+		chipProfile = *profileOverride;
+	}
+	else
 	{
-		const auto [ profileName, chipProfile ] = chipSelector.getChipProfile ( info->path (), info->dataFileName () );
+		const auto [ profileName, profile ] = chipSelector.getChipProfile ( info->path (), info->dataFileName () );
 
 		stiEZ.chipProfile = profileName;
-
-		engine.set6581FilterRange ( chipProfile.fltCox );
-		engine.set6581FilterCurve ( chipProfile.flt0Dac );
-		engine.set6581FilterGain ( chipProfile.fltGain );
-
-		engine.set6581DigiVolume ( chipProfile.digi );
-
-		engine.setCombinedWaveforms ( reSIDfp::CombinedWaveforms ( chipProfile.cwsLevel ), float ( chipProfile.cwsThreshold ) );
+		chipProfile = profile;
 	}
 
 	// Override chip-profile for Emulation based SID editors (Cheesecutter, GoatTracker, SidWizard etc.)
 	{
-		if ( stiEZ.model[ 0 ] == "6581" && ! stiEZ.playroutineID.empty () )
+		if ( ! profileOverride && info->sidModel ( 0 ) != SidTuneInfo::model_t::SIDMODEL_8580 && ! stiEZ.playroutineID.empty () )
 		{
 			auto oldEmulation = [ this ]
 			{
 				stiEZ.chipProfile = "Editor uses reSID emulation";
 
-				engine.set6581FilterRange ( 0.5 );
-				engine.set6581FilterCurve ( 0.5 );
-				engine.set6581FilterGain ( 1.0 );
-				engine.set6581DigiVolume ( 1.0 );
-				engine.setCombinedWaveforms ( reSIDfp::CombinedWaveforms::STRONG, 1.0 );
+				chipProfile.fltCox = 0.5;
+				chipProfile.flt0Dac = 0.5;
+				chipProfile.fltGain = 1.0;
+				chipProfile.digi = 1.0;
+				chipProfile.cwsLevel = ChipSelector::strong;
+				chipProfile.cwsThreshold = 1.0;
 			};
 
 			static const std::vector<std::string>	editorsUsingEmulation = {
@@ -139,9 +118,75 @@ bool libsidplayEZ::Player::setTuneNumber ( const unsigned int songNo )
 		}
 	}
 
+	engine.set6581FilterRange ( chipProfile.fltCox );
+	engine.set6581FilterCurve ( chipProfile.flt0Dac );
+	engine.set6581FilterGain ( chipProfile.fltGain );
+
+	engine.set6581DigiVolume ( chipProfile.digi );
+
+	engine.setCombinedWaveforms ( reSIDfp::CombinedWaveforms ( chipProfile.cwsLevel ), float ( chipProfile.cwsThreshold ) );
+
+	// Initialize SID engine(s)
+	config.playback = forceMono || info->sidChips () == 1 ? SidConfig::playback_t::MONO : SidConfig::playback_t::STEREO;
+
+	// Unload first, so a change of configuration doesn't run the init routine twice
+	engine.loadTune ( nullptr );
+
+	if ( ! engine.setConfig ( config ) )
+		return false;
+
+	// Load the tune, reusing the machine state after the init routine if known
+	const auto	initialState = stateCache.find ( stiEZ.md5, stiEZ.currentSong, config, chipProfile );
+
+	readyToPlay = engine.loadTune ( &tune, initialState );
+
+	if ( ! readyToPlay )
+		return false;
+
+	if ( ! initialState )
+	{
+		libsidplayfp::Snapshot	state;
+		if ( engine.snapshot ( state ) )
+			stateCache.insert ( stiEZ.md5, stiEZ.currentSong, config, chipProfile, std::move ( state ) );
+	}
+
+	// Fill the info struct for this particular tune
+	{
+		// Model(s), as emulated
+		stiEZ.model.clear ();
+		for ( auto i = 0; i < engine.getNumChips (); ++i )
+		{
+			const auto	is8580 = config.forceSidModel ? config.defaultSidModel == SidConfig::MOS8580 : info->sidModel ( i ) == SidTuneInfo::model_t::SIDMODEL_8580;
+			stiEZ.model.emplace_back ( is8580 ? "8580" : "6581" );
+		}
+
+		// Clock
+		stiEZ.clock = info->clockSpeed () == SidTuneInfo::clock_t::CLOCK_NTSC ? "NTSC" : "PAL";
+
+		// Speed
+		const auto& engineInfo = (const SidInfoImpl&)engine.getInfo ();
+
+		stiEZ.speed = engineInfo.speedString ();
+	}
+
 	return readyToPlay;
 }
 //-----------------------------------------------------------------------------
 
+bool Player::seekMs ( uint32_t ms )
+{
+	if ( ! readyToPlay )
+		return false;
+
+	// Seeking backwards restarts from the initialised state, if still cached,
+	// unless capturing the SID writes where the initialisation must be emulated
+	if ( ms < engine.timeMs () && ! engine.getSidTrace () )
+		if ( const auto	initialState = stateCache.find ( stiEZ.md5, stiEZ.currentSong, config, chipProfile ) )
+			engine.restore ( *initialState );
+
+	return engine.seekMs ( ms );
+}
+//-----------------------------------------------------------------------------
+
 }
 //-----------------------------------------------------------------------------
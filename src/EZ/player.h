@@ -1,8 +1,12 @@
 #pragma once
 
+#include <optional>
+
 #include "../player.h"
+#include "../sidplayfp/residfp/TableCache.h"
 #include "sidid.h"
 #include "chip-selector.h"
+#include "state-cache.h"
 #include "SidTuneInfoEZ.h"
 
 namespace libsidplayEZ
@@ -13,35 +17,79 @@ namespace libsidplayEZ
 class Player final
 {
 public:
-	bool loadSidIDConfig ( const char* filename ) { return sidID.loadSidIDConfig ( filename ); }
-	void setChipProfileMap ( const ChipSelector::profileMap& map ) { chipSelector.setProfiles ( map ); }
+	// The cached states depend on the chip profile picked, and so on both of these
+	bool loadSidIDConfig ( const char* filename ) { stateCache.clear ();	return sidID.loadSidIDConfig ( filename ); }
+	void setChipProfileMap ( const ChipSelector::profileMap& map ) { chipSelector.setProfiles ( map );	stateCache.clear ();	}
+
+	// Directory to cache the filter tables in, so later starts map them instead of building them.
+	// Set before creating the first player, empty turns the cache off
+	static void setFilterTableCache ( const std::string& directory ) { reSIDfp::TableCache::setDirectory ( directory ); }
 
 	void setRoms ( const void* kernal, const void* basic, const void* character );
 
 	void setSamplerate ( const int _sampleRate );
+	[[ nodiscard ]] int getSamplerate () const { return config.frequency; }
+
+	// Trade quality for speed, for previews. See SidConfig::sampling_method_t
+	void setSamplingMethod ( SidConfig::sampling_method_t method ) { config.samplingMethod = method; }
+
+	// Mix all chips into one channel, instead of stereo for tunes with more than one
+	void setForceMono ( bool enable ) { forceMono = enable; }
+
+	// Emulate this chip model whatever the tune asks for, or the one of the tune
+	void setSidModel ( std::optional<SidConfig::sid_model_t> model ) { config.forceSidModel = model.has_value ();	config.defaultSidModel = model.value_or ( SidConfig::MOS6581 ); }
+
+	// Use these chip settings instead of the profile picked for the tune, std::nullopt to pick again
+	void setChipProfileOverride ( const std::optional<ChipSelector::settings>& profile ) { profileOverride = profile; }
+
+	// Memory budget for the states of initialised subtunes, 0 disables the cache
+	void setStateCacheBudget ( size_t bytes ) { stateCache.setBudget ( bytes ); }
 	bool isReadyToPlay () const { return readyToPlay; }
 
 	bool loadSidFile ( const char* filename );
 	bool setTuneNumber (const unsigned int songNo = 0 );
 	uint32_t runEmulation ( int16_t* dst, uint32_t lengthWanted )	{	return engine.play ( dst, lengthWanted );		}
-	bool getSidStatus ( int sidNum, uint8_t regs[ 32 ] )			{	return engine.getSidStatus ( sidNum, regs );	}
+
+	// Float samples with the full scale at 1.0, soft clipped unless disabled
+	uint32_t runEmulation ( float* dst, uint32_t lengthWanted )		{	return engine.play ( dst, lengthWanted );		}
+	void setSoftClip ( bool enable )								{	engine.setSoftClip ( enable );					}
+	bool seekMs ( uint32_t ms );
+
+	// Capture the SID writes of the tunes set up from now on, nullptr stops capturing
+	void setSidTrace ( libsidplayfp::SidTrace* trace )				{	engine.setSidTrace ( trace );					}
+	bool getSidStatus ( int sidNum, uint8_t regs[ 32 ] ) const		{	return engine.getSidStatus ( sidNum, regs );	}
+
+	// Wait-free from any thread, the state as of the end of the last runEmulation
+	bool getSidStatus ( libsidplayfp::SidStatus& status ) const		{	return engine.getSidStatus ( status );			}
 	uint16_t getInterruptCycles () const							{	return engine.getInterruptCycles ();			}
 
+	// Oscilloscope capture of the voices and the filter of each chip, see libsidplayfp::Player::setScope
+	void setScope ( double rate, unsigned int length )				{	engine.setScope ( rate, length );				}
+	uint32_t getScope ( int sidNum, int channel, float* buffer, uint32_t samples ) const	{	return engine.getScope ( sidNum, channel, buffer, samples );	}
+	[[ nodiscard ]] uint32_t getScopePosition ( int sidNum ) const	{	return engine.getScopePosition ( sidNum );		}
+
 	[[ nodiscard ]] int getNumChips () const { return engine.getNumChips (); }
 	[[ nodiscard ]] const int getNumOutChannels () const { return config.playback; }
 
 	[[ nodiscard ]] const SidTuneInfoEZ& getFileInfo () const	{	return stiEZ;	}
 	[[ nodiscard ]] const SidTune& getSidTune () const { return tune; }
 
-	void setDacLeakage ( const double leakage )		{ engine.setDacLeakage ( leakage ); }
-	void set6581VoiceDrift ( const double drift )	{ engine.set6581VoiceDCDrift ( drift ); }
+	void setDacLeakage ( const double leakage )		{ engine.setDacLeakage ( leakage );			stateCache.clear ();	}
+	void set6581VoiceDrift ( const double drift )	{ engine.set6581VoiceDCDrift ( drift );	stateCache.clear ();	}
 
 	[[ nodiscard ]] unsigned int getEmulatedTimeMs () const { return engine.timeMs (); }
 
+	[[ nodiscard ]] const char* error () const { return engine.error (); }
+
 private:
 	bool	readyToPlay = false;
+	bool	forceMono = false;
+
+	ChipSelector			chipSelector;
+	ChipSelector::settings	chipProfile;	// As applied to the current tune, the cached states depend on it
 
-	ChipSelector	chipSelector;
+	std::optional<ChipSelector::settings>	profileOverride;
+	StateCache				stateCache;
 
 	libsidplayfp::Player	engine;
 
@@ -0,0 +1,64 @@
+#include "state-cache.h"
+
+namespace libsidplayEZ
+{
+
+//-----------------------------------------------------------------------------
+
+void StateCache::setBudget ( size_t bytes )
+{
+	budget = bytes;
+	trim ();
+}
+//-----------------------------------------------------------------------------
+
+const libsidplayfp::Snapshot* StateCache::find ( const std::string& md5, unsigned int song, const SidConfig& config, const ChipSelector::settings& profile )
+{
+	for ( auto it = entries.begin (); it != entries.end (); ++it )
+	{
+		if ( it->song != song || it->md5 != md5 || it->config.compare ( config ) || ! it->profile.sameChip ( profile ) )
+			continue;
+
+		entries.splice ( entries.begin (), entries, it );
+		return &entries.front ().state;
+	}
+
+	return nullptr;
+}
+//-----------------------------------------------------------------------------
+
+void StateCache::insert ( const std::string& md5, unsigned int song, const SidConfig& config, const ChipSelector::settings& profile, libsidplayfp::Snapshot&& state )
+{
+	if ( state.size () > budget )
+		return;
+
+	state.shrink_to_fit ();
+
+	used += state.size ();
+	entries.push_front ( { md5, song, config, profile, std::move ( state ) } );
+
+	entries.front ().profile.folder.clear ();
+	entries.front ().profile.exceptions.clear ();
+
+	trim ();
+}
+//-----------------------------------------------------------------------------
+
+void StateCache::clear ()
+{
+	entries.clear ();
+	used = 0;
+}
+//-----------------------------------------------------------------------------
+
+void StateCache::trim ()
+{
+	while ( used > budget )
+	{
+		used -= entries.back ().state.size ();
+		entries.pop_back ();
+	}
+}
+//-----------------------------------------------------------------------------
+
+}
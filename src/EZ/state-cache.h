@@ -0,0 +1,57 @@
+#pragma once
+
+#include <list>
+#include <string>
+
+#include "../snapshot.h"
+#include "../sidplayfp/SidConfig.h"
+#include "chip-selector.h"
+
+namespace libsidplayEZ
+{
+//-----------------------------------------------------------------------------
+
+/**
+* Least recently used machine states taken right after a tune's init routine,
+* so switching subtunes or replaying a tune doesn't emulate the initialisation again.
+* The init routine runs with the chip profile applied, so a state is only reused with the same one.
+*/
+class StateCache final
+{
+public:
+	/**
+	* Set the memory budget in bytes, 0 disables the cache.
+	*/
+	void setBudget ( size_t bytes );
+
+	/**
+	* Look up a state, making it the most recently used one.
+	*
+	* @return the state or nullptr if not cached
+	*/
+	[[ nodiscard ]] const libsidplayfp::Snapshot* find ( const std::string& md5, unsigned int song, const SidConfig& config, const ChipSelector::settings& profile );
+
+	void insert ( const std::string& md5, unsigned int song, const SidConfig& config, const ChipSelector::settings& profile, libsidplayfp::Snapshot&& state );
+
+	void clear ();
+
+private:
+	struct entry final
+	{
+		std::string				md5;
+		unsigned int			song;
+		SidConfig				config;
+		ChipSelector::settings	profile;	// Without the folder and exceptions
+		libsidplayfp::Snapshot	state;
+	};
+
+	std::list<entry>	entries;	// Most recently used first
+
+	size_t	budget = 16 * 1024 * 1024;
+	size_t	used = 0;
+
+	void trim ();
+};
+//-----------------------------------------------------------------------------
+
+}
@@ -38,10 +38,13 @@ class Event
 	friend class EventScheduler;
 
 	// The next event in sequence.
-	Event* next;
+	Event*	next = nullptr;
 
 	// The clock this event fires.
-	event_clock_t triggerTime;
+	event_clock_t triggerTime = 0;
+
+	// True while the event is in the scheduler queue.
+	bool	pending = false;
 
 public:
 	/**
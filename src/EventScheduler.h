@@ -21,6 +21,11 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <vector>
+
 #include "Event.h"
 
 #include "EZ/config.h"
@@ -54,37 +59,284 @@ using event_phase_t = enum
 * Scheduling an event for a phi1 clock when system is in phi2 causes the
 * event to be moved to the next phi1 cycle. Correspondingly, requesting
 * a phi1 time when system is in phi2 returns the value of the next phi1.
+*
+* Events flag themselves while queued, so isPending is a plain lookup and
+* cancelling an idle event costs nothing. Events scheduled past the end of
+* the chain (long CIA timer or TOD periods) are appended directly.
+*
+* Built with EVENTSCHEDULER_TIMING_WHEEL defined, the events due within the
+* next 256 half-cycles are kept in a timing wheel instead, see tools/bench-scheduler.
+* With the few events a C64 keeps queued the chain is faster.
 */
 class EventScheduler final
 {
 private:
+	// EventScheduler's current clock.
+	event_clock_t currentTime = 0;
+
+	// Events left to fire in the current run.
+	unsigned int	eventsLeft = 0;
+
+	// End of the current run, events due from then on are left for the next one.
+	event_clock_t	runEnd = std::numeric_limits<event_clock_t>::max ();
+
+	// Queue positions collected while restoring a snapshot.
+	std::vector<Event*>	restoredEvents;
+
+#ifndef EVENTSCHEDULER_TIMING_WHEEL
 	// The first event of the chain.
 	Event*	firstEvent = nullptr;
 
-	// EventScheduler's current clock.
-	event_clock_t currentTime = 0;
+	// The last event of the chain.
+	Event*	lastEvent = nullptr;
 
 	/**
 	* Scan the event queue and schedule event for execution.
 	*
 	* @param event The event to add
 	*/
-	sidinline void schedule ( Event& event )
+	sidinline void enqueue ( Event& event )
 	{
+		event.pending = true;
+
+		// Far away events usually end up at the tail
+		if ( lastEvent == nullptr || lastEvent->triggerTime <= event.triggerTime )
+		{
+			event.next = nullptr;
+			if ( lastEvent )	lastEvent->next = &event;
+			else				firstEvent = &event;
+			lastEvent = &event;
+			return;
+		}
+
 		// find the right spot where to tuck this new event
 		Event** scan = &firstEvent;
-		for ( ;;)
+		while ( ( *scan )->triggerTime <= event.triggerTime )
+			scan = &( ( *scan )->next );
+
+		event.next = *scan;
+		*scan = &event;
+	}
+
+	// Unlink a pending event
+	sidinline void dequeue ( Event& event )
+	{
+		Event*	prev = nullptr;
+		auto	scan = &firstEvent;
+
+		while ( *scan != &event )
 		{
-			if ( ( *scan == nullptr ) || ( ( *scan )->triggerTime > event.triggerTime ) )
-			{
-				event.next = *scan;
-				*scan = &event;
-				break;
-			}
+			prev = *scan;
 			scan = &( ( *scan )->next );
 		}
+
+		*scan = event.next;
+		if ( lastEvent == &event )
+			lastEvent = prev;
 	}
 
+	// The next event due, or nullptr
+	[[ nodiscard ]] sidinline Event* front () const { return firstEvent; }
+
+	// Unlink the next event due, the queue must not be empty
+	sidinline Event& takeFront ()
+	{
+		auto&	event = *firstEvent;
+
+		firstEvent = event.next;
+		if ( firstEvent == nullptr )
+			lastEvent = nullptr;
+
+		return event;
+	}
+
+	// Visit the pending events in the order they fire
+	template<typename F>
+	void forEachPending ( F&& visit )
+	{
+		for ( auto scan = firstEvent; scan; scan = scan->next )
+			visit ( *scan );
+	}
+
+	void clearQueue ()
+	{
+		firstEvent = nullptr;
+		lastEvent = nullptr;
+	}
+#else
+	// Half-cycles covered by the wheel, the events due later wait in a chain
+	static constexpr auto	SLOTS = 256;
+
+	// Events due at the same time, in the order they were scheduled
+	struct slot_t
+	{
+		Event*	head = nullptr;
+		Event*	tail = nullptr;
+	};
+
+	// All events of a slot are due at the same time, as the wheel spans less than a turn
+	slot_t		slots[ SLOTS ];
+	uint64_t	occupied[ SLOTS / 64 ] = {};
+
+	// Events beyond the wheel, in order
+	Event*	farEvents = nullptr;
+
+	sidinline void pushSlot ( Event& event )
+	{
+		const auto	index = int ( event.triggerTime & ( SLOTS - 1 ) );
+		auto&		slot = slots[ index ];
+
+		event.next = nullptr;
+		if ( slot.tail )	slot.tail->next = &event;
+		else				slot.head = &event;
+		slot.tail = &event;
+
+		occupied[ index >> 6 ] |= uint64_t ( 1 ) << ( index & 63 );
+	}
+
+	// Move the events which came within reach of the wheel, before anything due
+	// at the same time is scheduled directly into it
+	sidinline void migrate ()
+	{
+		while ( farEvents && farEvents->triggerTime < currentTime + SLOTS )
+		{
+			auto&	event = *farEvents;
+			farEvents = event.next;
+			pushSlot ( event );
+		}
+	}
+
+	sidinline void enqueue ( Event& event )
+	{
+		event.pending = true;
+
+		migrate ();
+
+		if ( event.triggerTime < currentTime + SLOTS )
+		{
+			pushSlot ( event );
+			return;
+		}
+
+		auto	scan = &farEvents;
+		while ( *scan && ( *scan )->triggerTime <= event.triggerTime )
+			scan = &( ( *scan )->next );
+
+		event.next = *scan;
+		*scan = &event;
+	}
+
+	sidinline void dequeue ( Event& event )
+	{
+		const auto	index = int ( event.triggerTime & ( SLOTS - 1 ) );
+		auto&		slot = slots[ index ];
+
+		Event*	prev = nullptr;
+		for ( auto scan = slot.head; scan; prev = scan, scan = scan->next )
+		{
+			if ( scan != &event )
+				continue;
+
+			if ( prev )		prev->next = event.next;
+			else			slot.head = event.next;
+
+			if ( slot.tail == &event )
+				slot.tail = prev;
+
+			if ( slot.head == nullptr )
+				occupied[ index >> 6 ] &= ~( uint64_t ( 1 ) << ( index & 63 ) );
+
+			return;
+		}
+
+		// Not moved into the wheel yet
+		auto	scan = &farEvents;
+		while ( *scan != &event )
+			scan = &( ( *scan )->next );
+
+		*scan = event.next;
+	}
+
+	// Index of the first occupied slot from the current time on, or -1
+	[[ nodiscard ]] sidinline int firstSlot () const
+	{
+		const auto	start = int ( currentTime & ( SLOTS - 1 ) );
+
+		for ( auto i = 0; i <= SLOTS / 64; i++ )
+		{
+			const auto	word = ( ( start >> 6 ) + i ) % ( SLOTS / 64 );
+
+			auto	bits = occupied[ word ];
+			if ( i == 0 )
+				bits &= ~uint64_t ( 0 ) << ( start & 63 );
+			else if ( i == SLOTS / 64 )
+				bits &= ~( ~uint64_t ( 0 ) << ( start & 63 ) );
+
+			if ( bits )
+				return word * 64 + std::countr_zero ( bits );
+		}
+
+		return -1;
+	}
+
+	[[ nodiscard ]] sidinline Event* front ()
+	{
+		migrate ();
+
+		const auto	index = firstSlot ();
+		return index < 0 ? farEvents : slots[ index ].head;
+	}
+
+	sidinline Event& takeFront ()
+	{
+		migrate ();
+
+		const auto	index = firstSlot ();
+		if ( index < 0 )
+		{
+			auto&	event = *farEvents;
+			farEvents = event.next;
+			return event;
+		}
+
+		auto&	slot = slots[ index ];
+		auto&	event = *slot.head;
+
+		slot.head = event.next;
+		if ( slot.head == nullptr )
+		{
+			slot.tail = nullptr;
+			occupied[ index >> 6 ] &= ~( uint64_t ( 1 ) << ( index & 63 ) );
+		}
+
+		return event;
+	}
+
+	template<typename F>
+	void forEachPending ( F&& visit )
+	{
+		migrate ();
+
+		const auto	start = int ( currentTime & ( SLOTS - 1 ) );
+
+		for ( auto i = 0; i < SLOTS; i++ )
+			for ( auto scan = slots[ ( start + i ) & ( SLOTS - 1 ) ].head; scan; scan = scan->next )
+				visit ( *scan );
+
+		for ( auto scan = farEvents; scan; scan = scan->next )
+			visit ( *scan );
+	}
+
+	void clearQueue ()
+	{
+		for ( auto& slot : slots )
+			slot = {};
+
+		std::fill ( std::begin ( occupied ), std::end ( occupied ), 0 );
+		farEvents = nullptr;
+	}
+#endif
+
 public:
 	/**
 	* Add event to pending queue.
@@ -99,7 +351,7 @@ public:
 	{
 		// this strange formulation always selects the next available slot regardless of specified phase.
 		event.triggerTime = currentTime + ( ( currentTime & 1 ) ^ phase ) + ( cycles << 1 );
-		schedule ( event );
+		enqueue ( event );
 	}
 
 	/**
@@ -111,7 +363,7 @@ public:
 	sidinline void schedule ( Event& event, unsigned int cycles )
 	{
 		event.triggerTime = currentTime + ( cycles << 1 );
-		schedule ( event );
+		enqueue ( event );
 	}
 
 	/**
@@ -121,17 +373,11 @@ public:
 	*/
 	sidinline void cancel ( Event& event )
 	{
-		auto    scan = &firstEvent;
+		if ( ! event.pending )
+			return;
 
-		while ( *scan )
-		{
-			if ( &event == *scan )
-			{
-				*scan = ( *scan )->next;
-				break;
-			}
-			scan = &( ( *scan )->next );
-		}
+		event.pending = false;
+		dequeue ( event );
 	}
 
 	/**
@@ -139,8 +385,11 @@ public:
 	*/
 	void reset ()
 	{
-		firstEvent = nullptr;
+		forEachPending ( [] ( Event& event ) { event.pending = false; } );
+
+		clearQueue ();
 		currentTime = 0;
+		eventsLeft = 0;
 	}
 
 	/**
@@ -148,30 +397,174 @@ public:
 	*/
 	sidinline void clock ()
 	{
-		auto&	event = *firstEvent;
-		firstEvent = firstEvent->next;
+		auto&	event = takeFront ();
+
+		event.pending = false;
 		currentTime = event.triggerTime;
 		event.event ();
 	}
 
 	/**
-	* Check if an event is in the queue.
+	* Fire a number of events, advancing system time accordingly.
+	*
+	* @param events how many events to fire
+	*/
+	sidinline void run ( unsigned int events )
+	{
+		eventsLeft = events;
+
+		while ( eventsLeft )
+		{
+			eventsLeft--;
+			clock ();
+		}
+	}
+
+	/**
+	* Fire the events due before a PHI1 clock, advancing system time up to it
+	* whether or not there's an event at the last cycle.
+	*
+	* @param target the PHI1 clock to stop at, see #getTime
+	*/
+	sidinline void runUntil ( event_clock_t target )
+	{
+		runEnd = target << 1;
+		eventsLeft = std::numeric_limits<unsigned int>::max ();
+
+		for ( auto next = front (); next && next->triggerTime < runEnd; next = front () )
+			clock ();
+
+		// Nothing is due until the target, just idle up to it
+		currentTime = std::max ( currentTime, runEnd - 1 );
+
+		runEnd = std::numeric_limits<event_clock_t>::max ();
+		eventsLeft = 0;
+	}
+
+	/**
+	* Advance the clock on behalf of an event which would otherwise
+	* reschedule itself, provided no other event is due until then.
+	* Only possible from within #run or #runUntil, each advance counts as one event.
+	*
+	* @param cycles how many cycles from now
+	* @return true if the clock has been advanced
+	*/
+	[[ nodiscard ]] sidinline bool advance ( unsigned int cycles )
+	{
+		const auto	time = currentTime + ( cycles << 1 );
+
+		if ( eventsLeft == 0 || time >= runEnd )
+			return false;
+
+		if ( const auto next = front (); next && next->triggerTime <= time )
+			return false;
+
+		eventsLeft--;
+		currentTime = time;
+		return true;
+	}
+
+	/**
+	* Skip whole iterations of a loop which repeats identically until
+	* some event changes the state, stopping before the next due event.
+	* Only possible from within #run or #runUntil, each skipped cycle counts as one event.
+	*
+	* @param period how many cycles one loop iteration takes
+	*/
+	sidinline void skip ( unsigned int period )
+	{
+		auto	cycles = event_clock_t ( eventsLeft );
+
+		// Stay strictly before the next event and the end of the run
+		if ( const auto next = front () )
+			cycles = std::min ( cycles, ( next->triggerTime - currentTime - 1 ) >> 1 );
+
+		cycles = std::min ( cycles, ( runEnd - currentTime - 1 ) >> 1 );
+
+		if ( cycles < event_clock_t ( period ) )
+			return;
+
+		cycles -= cycles % period;
+
+		eventsLeft -= unsigned ( cycles );
+		currentTime += cycles << 1;
+	}
+
+	/**
+	* Save or restore the clock and the queue length.
+	* Restoring cancels all events, the components then restore theirs
+	* through #serialize(Archive&, Event&) and #relink puts them back in order.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		auto	queued = 0u;
+
+		if constexpr ( Archive::loading )
+			reset ();
+		else
+			forEachPending ( [ &queued ] ( Event& ) { queued++; } );
+
+		ar ( currentTime, queued );
+
+		if constexpr ( Archive::loading )
+			restoredEvents.assign ( queued, nullptr );
+	}
+
+	/**
+	* Save or restore an event along with its position in the queue,
+	* which keeps the order of events due at the same time.
 	*
+	* @param ar the archive
 	* @param event the event
-	* @return true when pending
 	*/
-	[[ nodiscard ]] sidinline bool isPending ( Event& event ) const
+	template<class Archive>
+	void serialize ( Archive& ar, Event& event )
 	{
-		auto	scan = firstEvent;
-		while ( scan )
+		auto	position = -1;
+
+		if constexpr ( ! Archive::loading )
 		{
-			if ( &event == scan )
-				return true;
+			if ( event.pending )
+			{
+				auto	count = 0;
+				forEachPending ( [ &position, &count, &event ] ( Event& scan ) { if ( &scan == &event ) position = count;	count++; } );
+			}
+		}
+
+		ar ( event.triggerTime, position );
 
-			scan = scan->next;
+		if constexpr ( Archive::loading )
+			if ( position >= 0 && position < int ( restoredEvents.size () ) )
+				restoredEvents[ position ] = &event;
+	}
+
+	/**
+	* Queue the restored events.
+	*/
+	void relink ()
+	{
+		for ( auto event : restoredEvents )
+		{
+			if ( event == nullptr )
+				continue;
+
+			// In the order they fire, so each one goes after the ones before
+			enqueue ( *event );
 		}
 
-		return false;
+		restoredEvents.clear ();
+	}
+
+	/**
+	* Check if an event is in the queue.
+	*
+	* @param event the event
+	* @return true when pending
+	*/
+	[[ nodiscard ]] sidinline bool isPending ( Event& event ) const
+	{
+		return event.pending;
 	}
 
 	/**
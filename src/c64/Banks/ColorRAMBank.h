@@ -45,6 +45,9 @@ private:
 public:
 	void reset () { std::fill ( std::begin ( ram ), std::end ( ram ), 0 ); }
 
+	template<class Archive>
+	void serialize ( Archive& ar ) { ar ( ram ); }
+
 	sidinline void poke ( uint16_t address, uint8_t value ) override { ram[ address & 0x3ff ] = value & 0xf; }
 	sidinline uint8_t peek ( uint16_t address ) override { return ram[ address & 0x3ff ]; }
 };
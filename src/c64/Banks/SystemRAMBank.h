@@ -67,6 +67,12 @@ public:
 		}
 	}
 
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( ram );
+	}
+
 	sidinline uint8_t peek ( uint16_t address ) override				{	return ram[ address ];	}
 	sidinline void poke ( uint16_t address, uint8_t value ) override	{	ram[ address ] = value;	}
 };
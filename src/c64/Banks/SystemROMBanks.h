@@ -137,6 +137,15 @@ public:
 		setVal ( 0xfffc, get_16lo8 ( addr ) );
 		setVal ( 0xfffd, get_16hi8 ( addr ) );
 	}
+
+	/**
+	* Save or restore the patched RESET vector.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar.array ( rom + ( 0xfffc & 0x1fff ), 2 );
+	}
 };
 
 /**
@@ -193,6 +202,16 @@ public:
 		setVal ( 0xbf5c, 0xb1 );
 		setVal ( 0xbf5d, 0xa7 );
 	}
+
+	/**
+	* Save or restore the patched BASIC Warm Start and subtune code.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar.array ( rom + ( 0xa7ae & 0x1fff ), sizeof ( trap ) );
+		ar.array ( rom + ( 0xbf53 & 0x1fff ), sizeof ( subTune ) );
+	}
 };
 
 /**
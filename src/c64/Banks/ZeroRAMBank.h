@@ -182,6 +182,16 @@ public:
 		updateCpuPort ();
 	}
 
+	/**
+	* Save or restore the processor port.
+	* The PLA mapping is restored by the MMU.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( dataBit6, dataBit7, dir, data, dataRead, procPortPins );
+	}
+
 	uint8_t peek ( uint16_t address ) override
 	{
 		switch ( address )
@@ -81,6 +81,20 @@ public:
 
 	void reset ();
 
+	/**
+	* Save or restore the serial port state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( lastSync, count, cnt, cntHistory, loaded, pending, forceFinish );
+
+		eventScheduler.serialize ( ar, *this );
+		eventScheduler.serialize ( ar, flipCntEvent );
+		eventScheduler.serialize ( ar, flipFakeEvent );
+		eventScheduler.serialize ( ar, startSdrEvent );
+	}
+
 	void setModel4485 ( bool is4485 ) { model4485 = is4485; }
 
 	void startSdr ();
@@ -185,6 +185,20 @@ public:
 		asserted = false;
 	}
 
+	/**
+	* Save or restore the interrupt state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( last_clear, last_set, icr, idr, idrTemp, scheduled, asserted );
+
+		eventScheduler.serialize ( ar, interruptEvent );
+		eventScheduler.serialize ( ar, updateIdrEvent );
+		eventScheduler.serialize ( ar, setIrqEvent );
+		eventScheduler.serialize ( ar, clearIrqEvent );
+	}
+
 	/**
 		* Set interrupt control mask bits.
 		*
@@ -284,6 +284,24 @@ public:
 	*/
 	virtual void reset ();
 
+	/**
+	* Save or restore the CIA state.
+	* The model must be the same.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( regs );
+
+		timerA.serialize ( ar );
+		timerB.serialize ( ar );
+		interruptSource->serialize ( ar );
+		tod.serialize ( ar );
+		serialPort.serialize ( ar );
+
+		eventScheduler.serialize ( ar, bTickEvent );
+	}
+
 	/**
 	* Get the credits.
 	*
@@ -168,6 +168,18 @@ public:
 	*/
 	void reset ();
 
+	/**
+	* Save or restore the timer state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( ciaEventPauseTime, pbToggle, timer, latch, lastControlValue, state );
+
+		eventScheduler.serialize ( ar, *this );
+		eventScheduler.serialize ( ar, m_cycleSkippingEvent );
+	}
+
 	/**
 	* Set low byte of Timer start value (Latch).
 	*
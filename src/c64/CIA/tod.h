@@ -90,6 +90,17 @@ public:
 	*/
 	void reset ();
 
+	/**
+	* Save or restore the TOD state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( cycles, period, todtickcounter, isLatched, isStopped, clock, latch, alarm );
+
+		eventScheduler.serialize ( ar, *this );
+	}
+
 	/**
 	* Read TOD register.
 	*
@@ -52,11 +52,17 @@ void StaticFuncWrapper ( MOS6510& self )
 
 /**
 * When AEC signal is high, no stealing is possible.
+* Following cycles are run inline as long as no other event is due.
 */
 void MOS6510::eventWithoutSteals ()
 {
-	const auto&	instr = instrTable[ cycleCount++ ];
-	( instr.func )( *this );
+	do
+	{
+		const auto&	instr = instrTable[ cycleCount++ ];
+		( instr.func )( *this );
+	}
+	while ( eventScheduler.advance ( 1 ) );
+
 	eventScheduler.schedule ( m_nosteal, 1 );
 }
 
@@ -219,6 +225,7 @@ void MOS6510::interruptsAndNextOpcode ()
 		cycleCount = BRKn << 3;
 		d1x1 = true;
 		interruptCycle = MOS6510::MAX;
+		pollBranch = -1;
 	}
 	else
 	{
@@ -606,9 +613,20 @@ void MOS6510::cli_instr ()
 
 void MOS6510::jmp_instr ()
 {
+	const auto	selfJump = cycleCount == ( JMPw << 3 ) + 3 && uint16_t ( Cycle_EffectiveAddress + 3 ) == Register_ProgramCounter;
+
 	Register_ProgramCounter = Cycle_EffectiveAddress;
 
 	interruptsAndNextOpcode ();
+
+	// An absolute jump to itself only reads its own bytes,
+	// nothing changes until an event triggers an interrupt
+	if (	selfJump
+		&&	cycleCount == ( JMPw << 3 )
+		&&	interruptCycle == MOS6510::MAX
+		&&	isPlainMemory ( Cycle_EffectiveAddress )
+		&&	isPlainMemory ( Cycle_EffectiveAddress + 2 ) )
+		eventScheduler.skip ( 3 );
 }
 
 void MOS6510::pha_instr ()
@@ -886,6 +904,65 @@ void MOS6510::fix_branch ()
 	Register_ProgramCounter += Cycle_Data < 0x80 ? 0x0100 : 0xff00;
 }
 
+/**
+* Check for a loop polling memory, that is a read only instruction
+* followed by a branch back to it. Once the branch is taken twice in a row
+* without interrupts the loop repeats identically until an event
+* triggers an interrupt, so whole iterations can be skipped.
+*
+* @param branchAddr address of the branch instruction
+*/
+void MOS6510::checkPollLoop ( uint16_t branchAddr )
+{
+	const auto	bodyAddr = Register_ProgramCounter;
+	const auto	bodyLength = uint16_t ( branchAddr - bodyAddr );
+
+	if ( ( bodyLength != 2 && bodyLength != 3 ) || ! isPlainMemory ( bodyAddr ) || ! isPlainMemory ( branchAddr + 1 ) )
+	{
+		pollBranch = -1;
+		return;
+	}
+
+	unsigned int	bodyCycles;
+	switch ( cpuRead ( bodyAddr ) )
+	{
+		case LDAz: case LDXz: case LDYz: case CMPz: case CPXz: case CPYz:
+		case BITz: case ANDz: case ORAz:
+			bodyCycles = bodyLength == 2 ? 3 : 0;
+			break;
+
+		case LDAa: case LDXa: case LDYa: case CMPa: case CPXa: case CPYa:
+		case BITa: case ANDa: case ORAa:
+			bodyCycles = bodyLength == 3 ? 4 : 0;
+			break;
+
+		default:
+			bodyCycles = 0;
+			break;
+	}
+
+	auto	dataAddr = uint16_t ( cpuRead ( bodyAddr + 1 ) );
+	if ( bodyLength == 3 )
+		set_16hi8 ( dataAddr, cpuRead ( bodyAddr + 2 ) );
+
+	if ( bodyCycles == 0 || ! isPlainMemory ( dataAddr ) )
+	{
+		pollBranch = -1;
+		return;
+	}
+
+	// The first pass may have come from elsewhere, wait for a complete iteration
+	if ( pollBranch != branchAddr )
+	{
+		pollBranch = branchAddr;
+		return;
+	}
+
+	// Body plus taken branch on the same page
+	if ( interruptCycle == MOS6510::MAX )
+		eventScheduler.skip ( bodyCycles + 3 );
+}
+
 void MOS6510::branch_instr ( bool condition )
 {
 	// 2 cycles spent before arriving here. spend 0 - 2 cycles here;
@@ -902,6 +979,8 @@ void MOS6510::branch_instr ( bool condition )
 		// issue the spurious read for next insn here.
 		cpuRead ( Register_ProgramCounter );
 
+		const uint16_t	branchAddr = Register_ProgramCounter - 2;
+
 		Cycle_EffectiveAddress = get_16lo8 ( Register_ProgramCounter );
 		Cycle_EffectiveAddress += Cycle_Data;
 		adl_carry = ( Cycle_EffectiveAddress > 0xff ) != ( Cycle_Data > 0x7f );
@@ -918,11 +997,16 @@ void MOS6510::branch_instr ( bool condition )
 			// Hack: delay the interrupt past this instruction.
 			if ( interruptCycle >> 3 == cycleCount >> 3 )
 				interruptCycle += 2;
+
+			// Short backward branch, may be polling memory
+			if ( Cycle_Data > 0x7f )
+				checkPollLoop ( branchAddr );
 		}
 	}
 	else
 	{
 		// branch not taken: skip the following spurious read insn and go to FetchNextInstr immediately.
+		pollBranch = -1;
 		interruptsAndNextOpcode ();
 	}
 }
@@ -2032,6 +2116,7 @@ void MOS6510::Initialise ()
 	nmiFlag = false;
 	rstFlag = false;
 	interruptCycle = MOS6510::MAX;
+	pollBranch = -1;
 
 	// Signals
 	rdy = true;
@@ -104,6 +104,9 @@ private:
 	/// The RDY pin state during last throw away read.
 	bool rdyOnThrowAwayRead;
 
+	/// Address of the last taken branch polling memory, -1 if none
+	int pollBranch;
+
 	/// Status register
 	Flags flags;
 
@@ -141,6 +144,15 @@ private:
 	sidinline void interruptsAndNextOpcode ();
 	sidinline void calculateInterruptTriggerCycle ();
 
+	// Declare Idle Loop Detection
+	sidinline void checkPollLoop ( uint16_t branchAddr );
+
+	/**
+	* Reads outside of the I/O area and the processor port have no side
+	* effects and return the same value as long as the CPU doesn't write.
+	*/
+	static constexpr bool isPlainMemory ( uint16_t addr ) { return addr > 0x0001 && ( addr < 0xd000 || addr >= 0xe000 ); }
+
 	// Declare Instruction Routines
 	sidinline void fetchNextOpcode ();
 	sidinline void throwAwayFetch ();
@@ -290,6 +302,21 @@ public:
 
 	void reset ();
 
+	/**
+	* Save or restore the CPU state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( cycleCount, interruptCycle, irqAssertedOnPin, nmiFlag, rstFlag, rdy, adl_carry, d1x1, rdyOnThrowAwayRead, pollBranch, flags );
+		ar ( Register_ProgramCounter, Cycle_EffectiveAddress, Cycle_Pointer, Cycle_Data );
+		ar ( Register_StackPointer, Register_Accumulator, Register_X, Register_Y );
+
+		eventScheduler.serialize ( ar, m_nosteal );
+		eventScheduler.serialize ( ar, m_steal );
+		eventScheduler.serialize ( ar, clearInt );
+	}
+
 	static const char* credits ();
 
 	void setRDY ( bool newRDY );
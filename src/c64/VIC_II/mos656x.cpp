@@ -88,6 +88,8 @@ void MOS656X::reset ()
 	rasterClk = 0;
 	vblanking = false;
 	lpAsserted = false;
+	headlessAllowed = false;
+	headless = false;
 
 	std::fill ( std::begin ( regs ), std::end ( regs ), 0 );
 
@@ -160,6 +162,11 @@ void MOS656X::write ( uint8_t addr, uint8_t data )
 	// Sync up timers
 	sync ();
 
+	// Display, raster compare or sprite changes need the full model again,
+	// switch back right away so the following events are in their usual order
+	if ( addr == 0x11 || addr == 0x12 || addr == 0x15 || addr == 0x17 )
+		leaveHeadless ();
+
 	switch ( addr )
 	{
 		case 0x11: // Control register 1
@@ -262,7 +269,7 @@ void MOS656X::handleIrqState ()
 
 void MOS656X::event ()
 {
-	const event_clock_t cycles = eventScheduler.getTime ( eventScheduler.phase () ) - rasterClk;
+	event_clock_t cycles = eventScheduler.getTime ( eventScheduler.phase () ) - rasterClk;
 
 	event_clock_t delay;
 
@@ -270,14 +277,25 @@ void MOS656X::event ()
 	{
 		// Update x raster
 		rasterClk += cycles;
+
+		if ( headless )
+			skipLines ( cycles );
+
 		lineCycle += cycles;
 		lineCycle %= cyclesPerLine;
 
 		delay = ( this->*clock )( );
+
+		if ( lineCycle == 1 && ! headless )
+			headless = canRunHeadless ();
 	}
 	else
 		delay = 1;
 
+	// Without display and sprites only sleep until the next interesting line
+	if ( headless )
+		delay = headlessDelay ();
+
 	eventScheduler.schedule ( *this, (unsigned int)( delay - eventScheduler.phase () ), EVENT_CLOCK_PHI1 );
 }
 //-----------------------------------------------------------------------------
@@ -692,6 +710,9 @@ event_clock_t MOS656X::clockOldNTSC ()
 
 void MOS656X::triggerLightpen ()
 {
+	// The lightpen is only tracked by the full model
+	leaveHeadless ();
+
 	lpAsserted = true;
 
 	eventScheduler.schedule ( lightpenTriggerEvent, 1 );
@@ -704,4 +725,13 @@ void MOS656X::clearLightpen ()
 }
 //-----------------------------------------------------------------------------
 
+void MOS656X::allowHeadless ( bool allowed )
+{
+	if ( ! allowed )
+		leaveHeadless ();
+
+	headlessAllowed = allowed;
+}
+//-----------------------------------------------------------------------------
+
 }
@@ -114,6 +114,12 @@ private:
 	/// Is CIA asserting lightpen?
 	bool lpAsserted;
 
+	/// May we switch to the headless mode?
+	bool headlessAllowed;
+
+	/// Are we running without display and sprites, i.e. only line starts matter?
+	bool headless;
+
 	/// internal IRQ flags
 	uint8_t irqFlags;
 
@@ -261,6 +267,86 @@ private:
 		}
 	}
 
+	/**
+	* Check whether the VIC can run headless: with the display and the sprites
+	* off the only observable per-line work left is the raster counter and
+	* the raster IRQ, so we only need to wake up at line starts.
+	* Must be called right after line cycle 1, when BA has been released
+	* and mc equals mc_base for all sprites.
+	*/
+	[[ nodiscard ]] sidinline bool canRunHeadless () const
+	{
+		return		headlessAllowed
+				&&	! readDEN ()
+				&&	! areBadLinesEnabled
+				&&	! isBadLine
+				&&	! lpAsserted
+				&&	regs[ 0x15 ] == 0
+				&&	! sprites.isDma ( 0xff );
+	}
+
+	/**
+	* Go back to the full model, the next event is due on the following cycle.
+	*/
+	sidinline void leaveHeadless ()
+	{
+		if ( headless )
+		{
+			sync ();
+			headless = false;
+			sync ();
+		}
+	}
+
+	/**
+	* Run the line starts (cycle 0 and 1) crossed before the landing cycle
+	* when catching up in headless mode. All other cycles are no-ops then.
+	*
+	* @param cycles number of cycles to catch up, reduced to the cycles
+	*               left before the landing cycle
+	*/
+	sidinline void skipLines ( event_clock_t& cycles )
+	{
+		for ( ;; )
+		{
+			const event_clock_t	step = lineCycle == 0 ? 1 : cyclesPerLine - lineCycle;
+			if ( step >= cycles )
+				return;
+
+			cycles -= step;
+			lineCycle = ( lineCycle + unsigned ( step ) ) % cyclesPerLine;
+
+			if ( lineCycle == 0 )
+				checkVblank ();
+			else
+				vblank ();
+		}
+	}
+
+	/**
+	* Get the number of cycles to the next line start which can raise
+	* the raster IRQ in headless mode, or to the next frame start if the
+	* compare line is never reached.
+	*/
+	[[ nodiscard ]] sidinline event_clock_t headlessDelay () const
+	{
+		// Finish the frame start on the next cycle
+		if ( vblanking )
+			return 1;
+
+		const auto	rasterIrqLine = readRasterLineIRQ ();
+
+		unsigned int lines;
+		if ( rasterIrqLine == 0 || rasterIrqLine >= maxRasters )
+			lines = maxRasters - rasterY;
+		else if ( rasterIrqLine > rasterY )
+			lines = rasterIrqLine - rasterY;
+		else
+			lines = maxRasters - rasterY + rasterIrqLine;
+
+		return event_clock_t ( lines ) * cyclesPerLine - lineCycle;
+	}
+
 	/**
 	* Start DMA for sprite n.
 	*/
@@ -334,11 +420,37 @@ public:
 	*/
 	void clearLightpen ();
 
+	/**
+	* Allow the headless mode, where only line starts are clocked
+	* while display and sprites are off.
+	* Reset disallows it, so power-on delays measured in events stay the same.
+	*/
+	void allowHeadless ( bool allowed );
+
 	/**
 	* Reset VIC II.
 	*/
 	void reset ();
 
+	/**
+	* Save or restore the VIC state.
+	* The model must be the same.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( rasterClk, lineCycle, rasterY, yscroll );
+		ar ( areBadLinesEnabled, isBadLine, rasterYIRQCondition, vblanking, lpAsserted, headlessAllowed, headless );
+		ar ( irqFlags, irqMask, lp, regs );
+
+		sprites.serialize ( ar );
+
+		eventScheduler.serialize ( ar, *this );
+		eventScheduler.serialize ( ar, badLineStateChangeEvent );
+		eventScheduler.serialize ( ar, rasterYIRQEdgeDetectorEvent );
+		eventScheduler.serialize ( ar, lightpenTriggerEvent );
+	}
+
 	static const char* credits ();
 };
 
@@ -64,6 +64,12 @@ public:
 		std::fill ( std::begin ( mc ), std::end ( mc ), 0 );
 	}
 
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( exp_flop, dma, mc_base, mc );
+	}
+
     /**
      * Update mc values in one pass
      * after the dma has been processed
@@ -186,6 +186,11 @@ public:
 	*/
 	EventScheduler& getEventScheduler () { return eventScheduler; }
 
+	/**
+	* Get the number of PHI1 cycles since the reset.
+	*/
+	event_clock_t getTime () const { return eventScheduler.getTime ( EVENT_CLOCK_PHI1 ); }
+
 	uint32_t getTimeMs () const
 	{
 		return static_cast<uint32_t>( ( eventScheduler.getTime ( EVENT_CLOCK_PHI1 ) * 1000 ) / cpuFrequency );
@@ -198,9 +203,52 @@ public:
 	*/
 	void clock () { eventScheduler.clock (); }
 
+	/**
+	* Clock the emulation for a number of events.
+	*
+	* @throws haltInstruction
+	*/
+	void run ( unsigned int events ) { eventScheduler.run ( events ); }
+
+	/**
+	* Clock the emulation up to a PHI1 clock, no matter how many events it takes.
+	*
+	* @param target the clock to stop at, see EventScheduler::getTime
+	* @throws haltInstruction
+	*/
+	void runUntil ( event_clock_t target ) { eventScheduler.runUntil ( target ); }
+
 	void reset ();
 	void resetCpu () { cpu.reset (); }
 
+	/**
+	* Save or restore the state of the whole machine.
+	* Restoring requires the same model configuration, the SIDs are handled by their owner.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		eventScheduler.serialize ( ar );
+
+		ar ( irqCount, oldBAState, irqTime, irqStart );
+
+		cia1.serialize ( ar );
+		cia2.serialize ( ar );
+		vic.serialize ( ar );
+		colorRAMBank.serialize ( ar );
+		mmu.serialize ( ar );
+		cpu.serialize ( ar );
+
+		if constexpr ( Archive::loading )
+			eventScheduler.relink ();
+	}
+
+	/**
+	* Let the VIC only clock line starts while display and sprites are off.
+	* Cleared by reset.
+	*/
+	void allowHeadlessVic ( bool allowed ) { vic.allowHeadless ( allowed ); }
+
 	/**
 	* Set the c64 model.
 	*/
@@ -85,6 +85,13 @@ public:
 		MOS652X::reset ();
 	}
 
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		MOS652X::serialize ( ar );
+		ar ( last_ta );
+	}
+
 	sidinline uint16_t getTimerA () const { return last_ta; }
 };
 
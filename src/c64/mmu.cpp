@@ -100,6 +100,9 @@ void MMU::reset ()
 	hiram = false;
 	charen = false;
 
+	// Same bus noise on every run of a tune
+	seed = SEED;
+
 	updateMappingPHI2 ();
 }
 //-----------------------------------------------------------------------------
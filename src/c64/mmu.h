@@ -80,7 +80,8 @@ private:
 	ZeroRAMBank zeroRAMBank;
 
 	/// random seed
-	mutable unsigned int seed = 3686734;
+	static constexpr unsigned int	SEED = 3686734;
+	mutable unsigned int seed = SEED;
 
 private:
 	void setCpuPort ( uint8_t state ) override;
@@ -94,6 +95,23 @@ public:
 
 	void reset ();
 
+	/**
+	* Save or restore RAM, processor port and ROM patches.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( loram, hiram, charen, seed );
+
+		ramBank.serialize ( ar );
+		zeroRAMBank.serialize ( ar );
+		kernalRomBank.serialize ( ar );
+		basicRomBank.serialize ( ar );
+
+		if constexpr ( Archive::loading )
+			updateMappingPHI2 ();
+	}
+
 	// ROM banks methods
 	void setKernal ( const uint8_t* rom ) override { kernalRomBank.set ( rom ); }
 	void setBasic ( const uint8_t* rom ) override { basicRomBank.set ( rom ); }
@@ -22,6 +22,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <type_traits>
 
 #include "mixer.h"
 #include "sidemu.h"
@@ -40,67 +41,193 @@ void Mixer::clockChips ()
 void Mixer::resetBufs ()
 {
 	for ( auto chp : m_chips )
-		chp->bufferpos ( 0 );
+		chp->discard ();
 }
 //-----------------------------------------------------------------------------
 
-void Mixer::doMix ()
+void Mixer::fastForward ( bool enable )
 {
-	auto	outputBuffer = m_sampleBuffer + m_sampleIndex;
+	for ( auto chp : m_chips )
+		chp->fastForward ( enable );
+}
+//-----------------------------------------------------------------------------
 
-	// extract buffer info now that the SID is updated
-	// clock() may update bufferpos
-	// NB: if more than one chip exists, their bufferpos is identical to first chip's
-	const auto	sampleCount = m_chips.front ()->bufferpos ();
+void Mixer::settle ( bool enable )
+{
+	for ( auto chp : m_chips )
+		chp->settle ( enable );
+}
+//-----------------------------------------------------------------------------
 
-	auto	i = 0;
+/**
+* Mix a block of frames. The frames are mixed in chunks of a fixed size,
+* which the compiler turns into vector code, with a scalar tail.
+*
+* The int16_t samples are mixed exactly as ever, the float ones
+* with the same channel matrix in float.
+*/
+template<typename sample_t, int CHIPS, bool STEREO>
+static void mixKernel ( const sample_t* const* buffers, sample_t* __restrict__ out, int frames )
+{
+	constexpr auto	CHUNK = 16;
+
+	const sample_t* __restrict__	b0 = buffers[ 0 ];
+	const sample_t* __restrict__	b1 = buffers[ CHIPS > 1 ? 1 : 0 ];
+	const sample_t* __restrict__	b2 = buffers[ CHIPS > 2 ? 2 : 0 ];
 
-	// Specialization for one chip, mono out
-	if ( m_buffers.size () == 1 && m_stereo == false )
+	auto	mixFrame = [ b0, b1, b2, out ] ( const int i )
 	{
-		const auto	toCopy = std::min ( sampleCount, int ( m_sampleCount - m_sampleIndex ) );
+		if constexpr ( std::is_same_v<sample_t, int16_t> )
+		{
+			const auto	s0 = int32_t ( b0[ i ] );
+			const auto	s1 = int32_t ( b1[ i ] );
+			const auto	s2 = int32_t ( b2[ i ] );
+
+			if constexpr ( ! STEREO )
+			{
+				if constexpr ( CHIPS == 1 )	out[ i ] = int16_t ( s0 );
+				if constexpr ( CHIPS == 2 )	out[ i ] = int16_t ( ( s0 + s1 ) / 2 );
+				if constexpr ( CHIPS == 3 )	out[ i ] = int16_t ( ( s0 + s1 + s2 ) / 3 );
+			}
+			else
+			{
+				if constexpr ( CHIPS == 1 )
+				{
+					out[ i * 2 ] = int16_t ( s0 );
+					out[ i * 2 + 1 ] = int16_t ( s0 );
+				}
+				if constexpr ( CHIPS == 2 )
+				{
+					out[ i * 2 ] = int16_t ( s0 );
+					out[ i * 2 + 1 ] = int16_t ( s1 );
+				}
+				if constexpr ( CHIPS == 3 )
+				{
+					out[ i * 2 ] = int16_t ( ( Mixer::C1 * s0 + Mixer::C2 * s1 ) / Mixer::SCALE_FACTOR );
+					out[ i * 2 + 1 ] = int16_t ( ( Mixer::C2 * s1 + Mixer::C1 * s2 ) / Mixer::SCALE_FACTOR );
+				}
+			}
+		}
+		else
+		{
+			constexpr auto	c1 = float ( 1.0 / ( 1.0 + Mixer::SQRT_0_5 ) );
+			constexpr auto	c2 = float ( Mixer::SQRT_0_5 / ( 1.0 + Mixer::SQRT_0_5 ) );
+
+			if constexpr ( ! STEREO )
+			{
+				if constexpr ( CHIPS == 1 )	out[ i ] = b0[ i ];
+				if constexpr ( CHIPS == 2 )	out[ i ] = ( b0[ i ] + b1[ i ] ) * 0.5f;
+				if constexpr ( CHIPS == 3 )	out[ i ] = ( b0[ i ] + b1[ i ] + b2[ i ] ) * ( 1.0f / 3.0f );
+			}
+			else
+			{
+				if constexpr ( CHIPS == 1 )
+				{
+					out[ i * 2 ] = b0[ i ];
+					out[ i * 2 + 1 ] = b0[ i ];
+				}
+				if constexpr ( CHIPS == 2 )
+				{
+					out[ i * 2 ] = b0[ i ];
+					out[ i * 2 + 1 ] = b1[ i ];
+				}
+				if constexpr ( CHIPS == 3 )
+				{
+					out[ i * 2 ] = c1 * b0[ i ] + c2 * b1[ i ];
+					out[ i * 2 + 1 ] = c2 * b1[ i ] + c1 * b2[ i ];
+				}
+			}
+		}
+	};
 
-		std::copy_n ( m_buffers[ 0 ], toCopy, outputBuffer );
+	auto	i = 0;
 
-		m_sampleIndex += toCopy;
-		i = toCopy;
+	for ( ; i + CHUNK <= frames; i += CHUNK )
+	{
+		for ( auto j = 0; j < CHUNK; j++ )
+			mixFrame ( i + j );
 	}
-	else
+
+	for ( ; i < frames; i++ )
+		mixFrame ( i );
+}
+//-----------------------------------------------------------------------------
+
+template<typename sample_t>
+static Mixer::kernel_t<sample_t> getKernel ( int chips, bool stereo )
+{
+	switch ( chips )
 	{
-		const auto	channels = m_stereo ? 2u : 1u;
+		case 1:		return stereo ? mixKernel<sample_t, 1, true> : mixKernel<sample_t, 1, false>;
+		case 2:		return stereo ? mixKernel<sample_t, 2, true> : mixKernel<sample_t, 2, false>;
+		case 3:		return stereo ? mixKernel<sample_t, 3, true> : mixKernel<sample_t, 3, false>;
+		default:	return nullptr;
+	}
+}
+//-----------------------------------------------------------------------------
 
-		while (
-			   ( i < sampleCount )
-			&& ( m_sampleIndex < m_sampleCount )	// Handle whatever output the sid has generated so far
-			&& ( ( i + 1 ) < sampleCount )			// Are there enough samples to generate the next one?
-			)
-		{
-			m_iSamples[ 0 ] = m_buffers[ 0 ][ i ];
+template<typename sample_t>
+void Mixer::mix ( sample_t* outputBuffer, const std::vector<sample_t*>& buffers, kernel_t<sample_t> kernel )
+{
+	// NB: the chips are clocked together, their rings hold as many samples at the same offset
+	const auto	chip = m_chips.front ();
+	const auto	channels = m_stereo ? 2 : 1;
+
+	// One chip in mono takes all samples, the others hold the last one back
+	const auto	available = ( buffers.size () == 1 && ! m_stereo ) ? chip->samplesAvailable () : chip->samplesAvailable () - 1;
+	auto		frames = std::max ( 0, std::min ( available, int ( m_sampleCount - m_sampleIndex + channels - 1 ) / channels ) );
+
+	// Mix straight from the rings, in two pieces if the samples wrap around
+	while ( frames > 0 )
+	{
+		const auto	offset = chip->readOffset ();
+		const auto	count = std::min ( frames, int ( sidemu::OUTPUTBUFFERSIZE ) - offset );
 
-			for ( auto k = 1; k < int ( m_buffers.size () ); k++ )
-				m_iSamples[ k ] = m_buffers[ k ][ i ];
+		const sample_t*	input[ MAX_SIDS ];
+		for ( size_t k = 0; k < buffers.size (); k++ )
+			input[ k ] = buffers[ k ] + offset;
 
-			// increment i to mark we ate some samples
-			i++;
+		const auto	out = outputBuffer + m_sampleIndex;
 
-			*outputBuffer++ = int16_t ( ( this->*( m_mix[ 0 ] ) ) () );
-			if ( channels == 2 )
-				*outputBuffer++ = int16_t ( ( this->*( m_mix[ 1 ] ) ) () );
+		kernel ( input, out, count );
 
-			m_sampleIndex += channels;
+		if constexpr ( std::is_same_v<sample_t, float> )
+		{
+			if ( m_softClip )
+			{
+				for ( auto i = 0; i < count * channels; i++ )
+					out[ i ] = reSIDfp::SoftClip::clip ( out[ i ] );
+			}
 		}
+
+		m_sampleIndex += uint32_t ( count * channels );
+
+		for ( auto chp : m_chips )
+			chp->consume ( count );
+
+		frames -= count;
 	}
+}
+//-----------------------------------------------------------------------------
 
-	// move the unhandled data to start of buffer, if any
-	const auto	samplesLeft = sampleCount - i;
+int Mixer::samplesNeeded () const
+{
+	const auto	channels = m_stereo ? 2 : 1;
+	const auto	frames = int ( m_sampleCount - m_sampleIndex + channels - 1 ) / channels;
 
-	for ( auto bfr : m_buffers )
-		std::memmove ( bfr, bfr + i, samplesLeft * sizeof ( int16_t ) );
+	// All but one chip in mono hold the last sample back
+	const auto	holdBack = ( m_chips.size () == 1 && ! m_stereo ) ? 0 : 1;
 
-	for ( auto chp : m_chips )
-		chp->bufferpos ( samplesLeft );
+	return std::max ( 0, frames + holdBack - m_chips.front ()->samplesAvailable () );
+}
+//-----------------------------------------------------------------------------
 
-	m_wait = uint32_t ( samplesLeft ) > m_sampleCount;
+void Mixer::doMix ()
+{
+	if ( m_float )
+		mix ( m_floatSampleBuffer, m_floatBuffers, m_floatKernel );
+	else
+		mix ( m_sampleBuffer, m_buffers, m_kernel );
 }
 //-----------------------------------------------------------------------------
 
@@ -109,36 +236,40 @@ void Mixer::begin ( int16_t* buffer, uint32_t count )
 	// don't allow odd counts for stereo playback
 	assert ( m_stereo == false || ( count & 1 ) == 0 );
 
-	// we need a minimum buffer-size, otherwise a crash might occur
-	assert ( count > ( ( m_stereo + 1 ) * 100 ) );
-
 	m_sampleIndex = 0;
 	m_sampleCount = count;
 	m_sampleBuffer = buffer;
 
-	m_wait = false;
+	setFloatOutput ( false );
+}
+//-----------------------------------------------------------------------------
+
+void Mixer::begin ( float* buffer, uint32_t count )
+{
+	// don't allow odd counts for stereo playback
+	assert ( m_stereo == false || ( count & 1 ) == 0 );
+
+	m_sampleIndex = 0;
+	m_sampleCount = count;
+	m_floatSampleBuffer = buffer;
+
+	setFloatOutput ( true );
+}
+//-----------------------------------------------------------------------------
+
+void Mixer::setFloatOutput ( bool enable )
+{
+	m_float = enable;
+
+	for ( auto chp : m_chips )
+		chp->floatOutput ( enable );
 }
 //-----------------------------------------------------------------------------
 
 void Mixer::updateParams ()
 {
-	switch ( m_buffers.size () )
-	{
-		case 1:
-			m_mix[ 0 ] = m_stereo ? &Mixer::stereo_OneChip : &Mixer::mono1;
-			m_mix[ 1 ] = &Mixer::stereo_OneChip;
-			break;
-
-		case 2:
-			m_mix[ 0 ] = m_stereo ? &Mixer::stereo_ch1_TwoChips : &Mixer::mono2;
-			m_mix[ 1 ] = &Mixer::stereo_ch2_TwoChips;
-			break;
-
-		case 3:
-			m_mix[ 0 ] = m_stereo ? &Mixer::stereo_ch1_ThreeChips : &Mixer::mono3;
-			m_mix[ 1 ] = &Mixer::stereo_ch2_ThreeChips;
-			break;
-	}
+	m_kernel = getKernel<int16_t> ( int ( m_buffers.size () ), m_stereo );
+	m_floatKernel = getKernel<float> ( int ( m_floatBuffers.size () ), m_stereo );
 }
 //-----------------------------------------------------------------------------
 
@@ -146,6 +277,7 @@ void Mixer::clearSids ()
 {
 	m_chips.clear ();
 	m_buffers.clear ();
+	m_floatBuffers.clear ();
 }
 //-----------------------------------------------------------------------------
 
@@ -156,6 +288,9 @@ void Mixer::addSid ( sidemu* chip )
 
 	m_chips.push_back ( chip );
 	m_buffers.push_back ( chip->buffer () );
+	m_floatBuffers.push_back ( chip->floatBuffer () );
+
+	chip->floatOutput ( m_float );
 
 	updateParams ();
 }
@@ -47,44 +47,44 @@ public:
 	static constexpr auto C1 = static_cast<int32_t>( 1.0 / ( 1.0 + SQRT_0_5 ) * SCALE_FACTOR );
 	static constexpr auto C2 = static_cast<int32_t>( SQRT_0_5 / ( 1.0 + SQRT_0_5 ) * SCALE_FACTOR );
 
+	/**
+	* Mix a block of frames from the chip buffers into the output,
+	* specialised for each number of chips and channels.
+	*/
+	template<typename sample_t>
+	using kernel_t = void ( * ) ( const sample_t* const* buffers, sample_t* out, int frames );
+
 private:
 	std::vector<sidemu*>			m_chips;
 	std::vector<int16_t*>			m_buffers;
-	int32_t							m_iSamples[ MAX_SIDS ] = {};
-
-	// Mono mixing
-	int32_t mono1 () const { return m_iSamples[ 0 ]; }
-	int32_t mono2 () const { return ( m_iSamples[ 0 ] + m_iSamples[ 1 ] ) / 2; }
-	int32_t mono3 () const { return ( m_iSamples[ 0 ] + m_iSamples[ 1 ] + m_iSamples[ 2 ] ) / 3; }
-
-	// Stereo mixing
-	int32_t stereo_OneChip () const { return m_iSamples[ 0 ]; }
+	std::vector<float*>				m_floatBuffers;
 
-	int32_t stereo_ch1_TwoChips () const { return m_iSamples[ 0 ]; }
-	int32_t stereo_ch2_TwoChips () const { return m_iSamples[ 1 ]; }
+	kernel_t<int16_t>	m_kernel = nullptr;
+	kernel_t<float>		m_floatKernel = nullptr;
 
-	int32_t stereo_ch1_ThreeChips () const { return ( C1 * m_iSamples[ 0 ] + C2 * m_iSamples[ 1 ] ) / SCALE_FACTOR; }
-	int32_t stereo_ch2_ThreeChips () const { return ( C2 * m_iSamples[ 1 ] + C1 * m_iSamples[ 2 ] ) / SCALE_FACTOR; }
-
-	using mixer_func_t = int32_t ( Mixer::* )( ) const;
-	mixer_func_t	m_mix[ 2 ] = { &Mixer::mono1, nullptr };
-
-	using scale_func_t = int ( Mixer::* )( unsigned int );
+	template<typename sample_t>
+	void mix ( sample_t* outputBuffer, const std::vector<sample_t*>& buffers, kernel_t<sample_t> kernel );
 
 	static constexpr int32_t	VOLUME_MAX = 1024;
 
 	// Mixer settings
 	int16_t*	m_sampleBuffer = nullptr;
+	float*		m_floatSampleBuffer = nullptr;
 	uint32_t	m_sampleCount = 0;
 	uint32_t	m_sampleIndex = 0;
 
 	uint32_t	m_sampleRate = 0;
 
 	bool	m_stereo = false;
-	bool	m_wait = false;
+
+	// Mixing float samples, soft clipped or not
+	bool	m_float = false;
+	bool	m_softClip = true;
 
 	void updateParams ();
 
+	void setFloatOutput ( bool enable );
+
 	/*
 	* Channel matrix
 	*
@@ -107,6 +107,9 @@ private:
 	*/
 
 public:
+	/**
+	* Mix the samples produced so far into the output buffer, consuming them from the chips
+	*/
 	void doMix ();
 
 	/**
@@ -115,10 +118,24 @@ public:
 	void clockChips ();
 
 	/**
-	* Reset sidemu buffer position discarding produced samples
+	* Discard the samples produced and not mixed yet
 	*/
 	void resetBufs ();
 
+	/**
+	* Enable or disable fast forwarding of all SID chips
+	*
+	* @param enable true to only advance the chip state without producing samples
+	*/
+	void fastForward ( bool enable );
+
+	/**
+	* Settle the analog output of all SID chips faster, after fast forwarding
+	*
+	* @param enable true to speed up, false for normal operation
+	*/
+	void settle ( bool enable );
+
 	/**
 	* Prepare for mixing cycle
 	*
@@ -127,6 +144,23 @@ public:
 	*/
 	void begin ( int16_t* buffer, uint32_t count );
 
+	/**
+	* Prepare for mixing cycle with float samples,
+	* the full scale of the int16_t samples at 1.0.
+	*
+	* @param buffer output buffer
+	* @param count size of the buffer in samples
+	*/
+	void begin ( float* buffer, uint32_t count );
+
+	/**
+	* Soft clip the float samples, as the int16_t ones always are.
+	* Without it they may exceed the range -1.0 to 1.0.
+	*
+	* @param enable true to clip
+	*/
+	void setSoftClip ( bool enable ) { m_softClip = enable; }
+
 	/**
 	* Remove all SIDs from the mixer
 	*/
@@ -161,6 +195,11 @@ public:
 	*/
 	void setSamplerate ( uint32_t rate );
 
+	/**
+	* Get the number of samples the chips still have to produce to fill the output buffer
+	*/
+	[[ nodiscard ]] int samplesNeeded () const;
+
 	/**
 	* Check if the buffer have been filled
 	*/
@@ -171,12 +210,12 @@ public:
 	*/
 	[[ nodiscard ]] sidinline uint32_t samplesGenerated () const { return m_sampleIndex; }
 
-	/*
-	 * Wait till we consume the buffer.
-	 */
-	[[ nodiscard ]] sidinline bool wait () const { return m_wait; }
-
 	[[ nodiscard ]] sidinline int getNumChips () const { return int ( m_chips.size () ); }
+
+	/**
+	* Check if the last mixing cycle was for float samples
+	*/
+	[[ nodiscard ]] sidinline bool isFloatOutput () const { return m_float; }
 };
 
 }
@@ -22,6 +22,9 @@
 
 #include "player.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "sidplayfp/SidTune.h"
 
 #include "sidemu.h"
@@ -154,16 +157,23 @@ void Player::initialise ()
 //		warmup ( 5 );
 	}
 
-	m_startTime = m_c64.getTimeMs ();
+	// The warmup above counts events, only skip idle VIC cycles from here on
+	m_c64.allowHeadlessVic ( true );
+
+	m_startClock = m_c64.getTime ();
+	m_startSample = m_mixer.getSid ( 0 ) ? m_mixer.getSid ( 0 )->readPosition () : 0;
+
+	traceCall ( true );
+	publishStatus ();
 }
 //-----------------------------------------------------------------------------
 
-bool Player::loadTune ( SidTune* tune )
+bool Player::loadTune ( SidTune* tune, const Snapshot* initialState )
 {
 	if ( m_tune = tune; tune )
 	{
 		// Must re-configure on fly for stereo support!
-		if ( ! setConfig ( m_cfg, true ) )
+		if ( ! setConfig ( m_cfg, true, initialState ) )
 		{
 			// Failed configuration with new tune, reject it
 			m_tune = nullptr;
@@ -175,9 +185,10 @@ bool Player::loadTune ( SidTune* tune )
 }
 //-----------------------------------------------------------------------------
 
-uint32_t Player::play ( int16_t* buffer, uint32_t count )
+template<typename sample_t>
+uint32_t Player::render ( sample_t* buffer, uint32_t count )
 {
-	constexpr auto	CYCLES = 3000u;
+	constexpr auto	CYCLES = event_clock_t ( 3000 );
 
 	// Make sure a tune is loaded
 	if ( ! m_tune )
@@ -195,16 +206,9 @@ uint32_t Player::play ( int16_t* buffer, uint32_t count )
 		{
 			if ( count && buffer )
 			{
-				// Clock chips and mix into output buffer
-				while ( m_mixer.notFinished () )
-				{
-					if ( ! m_mixer.wait () )
-						run ( CYCLES );
+				count = mix ();
 
-					m_mixer.clockChips ();
-					m_mixer.doMix ();
-				}
-				count = m_mixer.samplesGenerated ();
+				traceCall ( false, count );
 			}
 			else
 			{
@@ -212,11 +216,13 @@ uint32_t Player::play ( int16_t* buffer, uint32_t count )
 				auto	size = int ( m_c64.getMainCpuSpeed () / m_cfg.frequency );
 				while ( --size )
 				{
-					run ( CYCLES );
+					runFor ( CYCLES );
 
 					m_mixer.clockChips ();
 					m_mixer.resetBufs ();
 				}
+
+				traceCall ( true );
 			}
 		}
 		else
@@ -224,7 +230,7 @@ uint32_t Player::play ( int16_t* buffer, uint32_t count )
 			// Clock the machine
 			auto	size = int ( m_c64.getMainCpuSpeed () / m_cfg.frequency );
 			while ( --size )
-				run ( CYCLES );
+				runFor ( CYCLES );
 		}
 	}
 
@@ -237,11 +243,253 @@ uint32_t Player::play ( int16_t* buffer, uint32_t count )
 		catch ( configError const& ) {}
 		m_isPlaying = state_t::STOPPED;
 	}
+	else
+		publishStatus ();
 
 	return count;
 }
 //-----------------------------------------------------------------------------
 
+uint32_t Player::mix ()
+{
+	constexpr auto	CYCLES = event_clock_t ( 3000 );
+
+	// Run just as many cycles as needed for the samples still missing.
+	// The phase of the resampler may leave a sample for another short round
+	const auto	cyclesPerSample = m_c64.getMainCpuSpeed () / m_cfg.frequency;
+
+	// Mix what is left from the previous call, then clock chips and mix into output buffer
+	m_mixer.doMix ();
+
+	while ( m_mixer.notFinished () )
+	{
+		runFor ( std::min ( event_clock_t ( std::ceil ( m_mixer.samplesNeeded () * cyclesPerSample ) ), CYCLES ) );
+
+		m_mixer.clockChips ();
+		m_mixer.doMix ();
+	}
+
+	return m_mixer.samplesGenerated ();
+}
+//-----------------------------------------------------------------------------
+
+uint32_t Player::play ( int16_t* buffer, uint32_t count )
+{
+	return render ( buffer, count );
+}
+//-----------------------------------------------------------------------------
+
+uint32_t Player::play ( float* buffer, uint32_t count )
+{
+	return render ( buffer, count );
+}
+//-----------------------------------------------------------------------------
+
+bool Player::seekMs ( uint32_t ms )
+{
+	// Emulated with sound before the target, for filters and resampler to settle
+	constexpr auto	SETTLE_MS = 100u;
+
+	if ( ! m_tune )
+	{
+		m_errorString = "SIDPLAYER ERROR: No tune loaded.";
+		return false;
+	}
+
+	const auto	chip = m_mixer.getSid ( 0 );
+
+	// Samples mixed since the start, which is where the chips are in their streams
+	auto	played = [ this, chip ] { return chip->readPosition () - m_startSample; };
+
+	// The samples play reaches after the time requested, or without chips the cycle
+	const auto	frames = uint32_t ( ( uint64_t ( ms ) * m_cfg.frequency + 999 ) / 1000 );
+	const auto	cycles = event_clock_t ( std::ceil ( ms * m_c64.getMainCpuSpeed () / 1000.0 ) );
+
+	if ( chip ? frames < played () : m_startClock + cycles < m_c64.getTime () )
+	{
+		try
+		{
+			initialise ();
+		}
+		catch ( configError const& e )
+		{
+			m_errorString = e.message ();
+			return false;
+		}
+	}
+
+	if ( ! chip )
+	{
+		constexpr auto	CYCLES = event_clock_t ( 3000 );
+
+		while ( m_c64.getTime () < m_startClock + cycles )
+			runUntil ( std::min ( m_startClock + cycles, m_c64.getTime () + CYCLES ) );
+
+		publishStatus ();
+		return true;
+	}
+
+	// Clock the chips until they have produced the samples up to a position, dropping them all
+	auto	produce = [ this, &played ] ( uint32_t until )
+	{
+		constexpr auto	CYCLES = event_clock_t ( 3000 );
+
+		const auto	cyclesPerSample = m_c64.getMainCpuSpeed () / m_cfg.frequency;
+
+		while ( int32_t ( until - played () ) > 0 )
+		{
+			runFor ( std::min ( event_clock_t ( std::ceil ( ( until - played () ) * cyclesPerSample ) ), CYCLES ) );
+
+			m_mixer.clockChips ();
+			m_mixer.resetBufs ();
+		}
+	};
+
+	if ( const auto settleFrames = m_cfg.frequency * SETTLE_MS / 1000; frames - played () > settleFrames )
+	{
+		m_mixer.fastForward ( true );
+		produce ( frames - settleFrames );
+
+		// Charge the output high-pass quickly first, the filters settle on their own
+		m_mixer.fastForward ( false );
+		m_mixer.settle ( true );
+		produce ( frames - settleFrames / 2 );
+
+		m_mixer.settle ( false );
+		traceCall ( true );
+	}
+
+	// Mix the last samples just as play does and drop them, which leaves the chips
+	// at the same position in their streams, holding the same samples for the next call
+	auto	drop = [ this, &played, frames ] ( auto* buffer, uint32_t size )
+	{
+		const auto	channels = m_cfg.playback == SidConfig::STEREO ? 2u : 1u;
+
+		while ( const auto count = std::min ( frames - played (), size / channels ) * channels )
+		{
+			m_mixer.begin ( buffer, count );
+			traceCall ( false, mix (), true );
+		}
+	};
+
+	if ( m_mixer.isFloatOutput () )
+	{
+		float	buffer[ 1024 ];
+		drop ( buffer, uint32_t ( std::size ( buffer ) ) );
+	}
+	else
+	{
+		int16_t	buffer[ 1024 ];
+		drop ( buffer, uint32_t ( std::size ( buffer ) ) );
+	}
+
+	publishStatus ();
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+void Player::setSidTrace ( SidTrace* trace )
+{
+	m_trace = trace;
+
+	for ( auto i = 0; i < 3; i++ )
+		if ( m_sidEmu[ i ] )
+			m_sidEmu[ i ]->trace ( trace, i );
+}
+//-----------------------------------------------------------------------------
+
+void Player::traceCall ( bool discarded, uint32_t samples, bool dropped )
+{
+	if ( ! m_trace )
+		return;
+
+	const auto	clk = m_c64.getEventScheduler ().getTime ( EVENT_CLOCK_PHI1 );
+
+	if ( discarded )
+		m_trace->skip ( clk );
+	else
+		m_trace->time ( clk, samples, dropped );
+}
+//-----------------------------------------------------------------------------
+
+template<class Archive>
+void Player::serialize ( Archive& ar )
+{
+	m_c64.serialize ( ar );
+
+	for ( auto i = 0; i < getNumChips (); i++ )
+		m_mixer.getSid ( i )->serialize ( ar );
+
+	ar ( m_isPlaying, m_startClock, m_startSample );
+	ar ( m_info.m_driverAddr, m_info.m_driverLength, m_info.m_powerOnDelay );
+}
+//-----------------------------------------------------------------------------
+
+// Bump when the layout of any serialized component changes
+constexpr uint32_t	SNAPSHOT_VERSION = 6;
+
+bool Player::snapshot ( Snapshot& snapshot )
+{
+	if ( ! m_tune )
+	{
+		m_errorString = "SIDPLAYER ERROR: No tune loaded.";
+		return false;
+	}
+
+	SnapshotWriter	ar ( snapshot );
+
+	ar ( SNAPSHOT_VERSION, m_cfg, getNumChips () );
+	serialize ( ar );
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+bool Player::restore ( const Snapshot& snapshot )
+{
+	if ( ! m_tune )
+	{
+		m_errorString = "SIDPLAYER ERROR: No tune loaded.";
+		return false;
+	}
+
+	SnapshotReader	ar ( snapshot );
+
+	auto		version = 0u;
+	SidConfig	cfg;
+	auto		chips = 0;
+
+	ar ( version, cfg, chips );
+
+	if ( version != SNAPSHOT_VERSION || cfg.compare ( m_cfg ) || chips != getNumChips () )
+	{
+		m_errorString = "SIDPLAYER ERROR: Snapshot does not match the current configuration.";
+		return false;
+	}
+
+	serialize ( ar );
+
+	if ( ! ar.complete () )
+	{
+		m_errorString = "SIDPLAYER ERROR: Snapshot is corrupt.";
+
+		// Don't leave a half restored machine behind
+		try
+		{
+			initialise ();
+		}
+		catch ( configError const& ) {}
+
+		return false;
+	}
+
+	publishStatus ();
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
 void Player::stop ()
 {
 	if ( m_tune && m_isPlaying == state_t::PLAYING )
@@ -249,7 +497,7 @@ void Player::stop ()
 }
 //-----------------------------------------------------------------------------
 
-bool Player::setConfig ( const SidConfig& cfg, bool force )
+bool Player::setConfig ( const SidConfig& cfg, bool force, const Snapshot* initialState )
 {
 	// Check if configuration have been changed or forced
 	if ( ! force && ! m_cfg.compare ( cfg ) )
@@ -305,10 +553,12 @@ bool Player::setConfig ( const SidConfig& cfg, bool force )
 			};
 			m_c64.setCiaModel ( getCiaModel ( cfg.ciaModel ) );
 
-			sidParams ( m_c64.getMainCpuSpeed (), cfg.frequency );
+			sidParams ( m_c64.getMainCpuSpeed (), cfg.frequency, cfg.samplingMethod );
 
-			// Configure, setup and install C64 environment/events
-			initialise ();
+			// Configure, setup and install C64 environment/events,
+			// unless the state after the initialisation is known already
+			if ( m_trace || ! initialState || ! restore ( *initialState ) )
+				initialise ();
 		}
 		catch ( configError const& e )
 		{
@@ -448,8 +698,13 @@ void Player::sidCreate ( SidConfig::sid_model_t defaultModel, bool forced, const
 	{
 		defaultModel = getSidModel ( tuneInfo->sidModel ( i ), defaultModel, forced );
 
-		auto	s = &m_sidEmu[ i ];
+		// Fresh chips, so that nothing carries over from the previous tune
+		m_sidEmu[ i ] = std::make_unique<sidemu> ( m_c64.getEventScheduler () );
+
+		auto	s = m_sidEmu[ i ].get ();
+		s->trace ( m_trace, i );
 		s->model ( defaultModel );
+		applyChipSettings ( *s );
 
 		if ( i++ == 0 )
 			m_c64.setBaseSid ( s );
@@ -461,16 +716,21 @@ void Player::sidCreate ( SidConfig::sid_model_t defaultModel, bool forced, const
 }
 //-----------------------------------------------------------------------------
 
-void Player::sidParams ( double cpuFreq, int frequency )
+void Player::sidParams ( double cpuFreq, int frequency, SidConfig::sampling_method_t method )
 {
 	for ( auto i = 0; i < 3 ; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
-			s->sampling ( float ( cpuFreq ), frequency );
+		{
+			s->sampling ( float ( cpuFreq ), frequency, method );
+			s->scope ( cpuFreq, m_scopeRate, m_scopeLength );
+		}
 }
 //-----------------------------------------------------------------------------
 
 void Player::setCombinedWaveforms ( reSIDfp::CombinedWaveforms cws, const float threshold )
 {
+	m_chipSettings.combinedWaveforms = { cws, threshold };
+
 	for ( auto i = 0; i < 3; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
 			s->combinedWaveforms ( cws, threshold );
@@ -479,6 +739,8 @@ void Player::setCombinedWaveforms ( reSIDfp::CombinedWaveforms cws, const float
 
 void Player::set6581FilterCurve ( const double value )
 {
+	m_chipSettings.filter6581Curve = value;
+
 	for ( auto i = 0; i < 3; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
 			s->filter6581Curve ( value );
@@ -487,6 +749,8 @@ void Player::set6581FilterCurve ( const double value )
 
 void Player::set6581FilterRange ( const double value )
 {
+	m_chipSettings.filter6581Range = value;
+
 	for ( auto i = 0; i < 3; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
 			s->filter6581Range ( value );
@@ -495,6 +759,8 @@ void Player::set6581FilterRange ( const double value )
 
 void Player::set6581FilterGain ( const double value )
 {
+	m_chipSettings.filter6581Gain = value;
+
 	for ( auto i = 0; i < 3; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
 			s->filter6581Gain ( value );
@@ -503,6 +769,8 @@ void Player::set6581FilterGain ( const double value )
 
 void Player::set6581DigiVolume ( const double value )
 {
+	m_chipSettings.filter6581Digi = value;
+
 	for ( auto i = 0; i < 3; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
 			s->filter6581Digi ( value );
@@ -511,6 +779,8 @@ void Player::set6581DigiVolume ( const double value )
 
 void Player::setDacLeakage ( const double value )
 {
+	m_chipSettings.dacLeakage = value;
+
 	for ( auto i = 0; i < 3; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
 			s->setDacLeakage ( value );
@@ -519,27 +789,111 @@ void Player::setDacLeakage ( const double value )
 
 void Player::set6581VoiceDCDrift ( const double value )
 {
+	m_chipSettings.voice6581DCDrift = value;
+
 	for ( auto i = 0; i < 3; i++ )
 		if ( auto s = m_mixer.getSid ( i ) )
 			s->voice6581DCDrift ( value );
 }
 //-----------------------------------------------------------------------------
 
-bool Player::getSidStatus ( int sidNum, uint8_t regs[ 32 ] )
+void Player::applyChipSettings ( sidemu& s ) const
+{
+	const auto&	cs = m_chipSettings;
+
+	if ( cs.combinedWaveforms )		s.combinedWaveforms ( cs.combinedWaveforms->first, cs.combinedWaveforms->second );
+	if ( cs.filter6581Curve )		s.filter6581Curve ( *cs.filter6581Curve );
+	if ( cs.filter6581Range )		s.filter6581Range ( *cs.filter6581Range );
+	if ( cs.filter6581Gain )		s.filter6581Gain ( *cs.filter6581Gain );
+	if ( cs.filter6581Digi )		s.filter6581Digi ( *cs.filter6581Digi );
+	if ( cs.dacLeakage )			s.setDacLeakage ( *cs.dacLeakage );
+	if ( cs.voice6581DCDrift )		s.voice6581DCDrift ( *cs.voice6581DCDrift );
+}
+//-----------------------------------------------------------------------------
+
+bool Player::getSidStatus ( int sidNum, uint8_t regs[ 32 ] ) const
 {
-	if ( auto s = m_mixer.getSid ( sidNum ) )
+	SidStatus	status;
+
+	if ( ! m_status.read ( status ) || sidNum < 0 || sidNum >= status.chips )
+		return false;
+
+	std::copy_n ( status.registers[ sidNum ], 0x20, regs );
+
+	// Write envelope-levels into unused SID registers
+	regs[ 0x1d ] = uint8_t ( status.envelopes[ sidNum ][ 0 ] * 255.0f );
+	regs[ 0x1e ] = uint8_t ( status.envelopes[ sidNum ][ 1 ] * 255.0f );
+	regs[ 0x1f ] = uint8_t ( status.envelopes[ sidNum ][ 2 ] * 255.0f );
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+void Player::setScope ( double rate, unsigned int length )
+{
+	m_scopeRate = rate;
+	m_scopeLength = length;
+
+	for ( auto i = 0; i < 3; i++ )
+		if ( auto s = m_mixer.getSid ( i ) )
+			s->scope ( m_c64.getMainCpuSpeed (), rate, length );
+}
+//-----------------------------------------------------------------------------
+
+uint32_t Player::getScope ( int sidNum, int channel, float* buffer, uint32_t samples ) const
+{
+	if ( auto s = sidNum >= 0 ? m_mixer.getSid ( sidNum ) : nullptr )
+		return s->readScope ( channel, buffer, samples );
+
+	return 0;
+}
+//-----------------------------------------------------------------------------
+
+uint32_t Player::getScopePosition ( int sidNum ) const
+{
+	if ( auto s = sidNum >= 0 ? m_mixer.getSid ( sidNum ) : nullptr )
+		return s->getScopePosition ();
+
+	return 0;
+}
+//-----------------------------------------------------------------------------
+
+uint16_t Player::getCia1TimerA () const
+{
+	SidStatus	status;
+	return m_status.read ( status ) ? status.cia1TimerA : 0;
+}
+//-----------------------------------------------------------------------------
+
+uint16_t Player::getInterruptCycles () const
+{
+	SidStatus	status;
+	return m_status.read ( status ) ? status.interruptCycles : 0;
+}
+//-----------------------------------------------------------------------------
+
+void Player::publishStatus ()
+{
+	SidStatus	status;
+
+	status.timeMs = timeMs ();
+	status.interruptCycles = m_c64.getInterruptCycles ();
+	status.cia1TimerA = m_c64.getCia1TimerA ();
+	status.chips = uint8_t ( getNumChips () );
+
+	for ( auto i = 0; i < status.chips; i++ )
 	{
-		s->getStatus ( regs );
+		const auto	s = m_mixer.getSid ( i );
 
-		// Write envelope-levels into unused SID registers
-		regs[ 0x1d ] = uint8_t ( s->getInternalEnvValue ( 0 ) * 255.0f );
-		regs[ 0x1e ] = uint8_t ( s->getInternalEnvValue ( 1 ) * 255.0f );
-		regs[ 0x1f ] = uint8_t ( s->getInternalEnvValue ( 2 ) * 255.0f );
+		s->getStatus ( status.registers[ i ] );
+		status.osc3[ i ] = s->getOsc3 ();
+		status.env3[ i ] = s->getEnv3 ();
 
-		return true;
+		for ( auto v = 0; v < 3; v++ )
+			status.envelopes[ i ][ v ] = s->getInternalEnvValue ( v );
 	}
 
-	return false;
+	m_status.publish ( status );
 }
 //-----------------------------------------------------------------------------
 
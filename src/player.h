@@ -31,11 +31,16 @@
 #include "sidemu.h"
 
 #include "mixer.h"
+#include "snapshot.h"
+#include "sidtrace.h"
+#include "sidstatus.h"
 #include "c64/c64.h"
 
 #include "EZ/chip-selector.h"
 
 #include <atomic>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <unordered_map>
 
@@ -58,13 +63,37 @@ private:
 	SidInfoImpl	m_info;				// Tune info
 	SidConfig	m_cfg;				// User Configuration Settings
 
-	sidemu		m_sidEmu[ 3 ] = { m_c64.getEventScheduler (), m_c64.getEventScheduler (), m_c64.getEventScheduler () };		// emulation of an actual SID chip
+	std::unique_ptr<sidemu>	m_sidEmu[ 3 ];	// emulation of an actual SID chip, created along with the tune's configuration
 
 	std::string	m_errorString = "N/A";
 
-	state_t		m_isPlaying = state_t::STOPPED;	// Playback status
-	uint32_t	m_startTime = 0;
-	uint8_t		videoSwitch;					// PAL/NTSC switch value
+	SidTrace*	m_trace = nullptr;				// Capture of the SID writes
+
+	SidStatusBoard	m_status;					// State of the SIDs for other threads
+
+	// Chip settings made so far, also applied to the chips of tunes loaded later
+	struct chipSettings final
+	{
+		std::optional<std::pair<reSIDfp::CombinedWaveforms, float>>	combinedWaveforms;
+
+		std::optional<double>	filter6581Curve;
+		std::optional<double>	filter6581Range;
+		std::optional<double>	filter6581Gain;
+		std::optional<double>	filter6581Digi;
+		std::optional<double>	dacLeakage;
+		std::optional<double>	voice6581DCDrift;
+	};
+
+	chipSettings	m_chipSettings;
+
+	// Oscilloscope capture, also set up for the chips of tunes loaded later
+	double			m_scopeRate = 0.0;
+	unsigned int	m_scopeLength = 0;
+
+	state_t			m_isPlaying = state_t::STOPPED;	// Playback status
+	event_clock_t	m_startClock = 0;				// Cycle the tune starts playing at
+	uint32_t		m_startSample = 0;				// Samples the chips produced up to then, wrapping around
+	uint8_t			videoSwitch;					// PAL/NTSC switch value
 
 	/**
 	* Get the C64 model for the current loaded tune.
@@ -79,29 +108,107 @@ private:
 	void sidRelease ();
 	void sidCreate ( SidConfig::sid_model_t defaultModel, bool forced, const std::vector<uint16_t>& sidAddresses );
 
-	void sidParams ( double cpuFreq, int frequency );
+	void sidParams ( double cpuFreq, int frequency, SidConfig::sampling_method_t method );
 
-	sidinline void run ( unsigned int events )
-	{
-		while ( events-- )
-			m_c64.clock ();
-	}
+	void applyChipSettings ( sidemu& s ) const;
+
+	bool setConfig ( const SidConfig& cfg, bool force, const Snapshot* initialState );
+
+	sidinline void run ( unsigned int events )	{	m_c64.run ( events );	}
+	sidinline void runUntil ( event_clock_t target )	{	m_c64.runUntil ( target );	}
+	sidinline void runFor ( event_clock_t cycles )		{	m_c64.runUntil ( m_c64.getTime () + cycles );	}
+
+	void traceCall ( bool discarded, uint32_t samples = 0, bool dropped = false );
+
+	// Mix into the buffer set up with the mixer, clocking the machine just as long as needed
+	uint32_t mix ();
+
+	// Hand the state of the SIDs over to the readers of #getSidStatus
+	void publishStatus ();
+
+	template<typename sample_t>
+	uint32_t render ( sample_t* buffer, uint32_t count );
+
+	template<class Archive>
+	void serialize ( Archive& ar );
 
 public:
 	Player ();
 
-	bool setConfig ( const SidConfig& cfg, bool force = false );
+	bool setConfig ( const SidConfig& cfg, bool force = false ) { return setConfig ( cfg, force, nullptr ); }
 	[[ nodiscard ]] const SidConfig& getConfig () const { return m_cfg; }
 
 	[[ nodiscard ]] const SidInfo& getInfo () const { return m_info; }
 
-	bool loadTune ( SidTune* tune );
+	/**
+	* Load a tune and run its initialisation.
+	*
+	* @param tune the tune to load, nullptr unloads the current tune
+	* @param initialState optional snapshot taken right after a previous initialisation
+	*        of the same tune with the same configuration, restored instead of emulating it again
+	*/
+	bool loadTune ( SidTune* tune, const Snapshot* initialState = nullptr );
 	uint32_t play ( int16_t* buffer, uint32_t samples );
+
+	/**
+	* Play into float samples, the full scale of the int16_t samples at 1.0.
+	* They stay float through the mixer, soft clipped only if enabled.
+	*/
+	uint32_t play ( float* buffer, uint32_t samples );
+
+	/**
+	* Soft clip the float samples of play(), enabled by default.
+	* Without it they keep the headroom and may exceed -1.0 to 1.0.
+	*/
+	void setSoftClip ( bool enable ) { m_mixer.setSoftClip ( enable ); }
 	void stop ();
+
+	/**
+	* Seek to a position without generating audio.
+	* The SIDs only latch the register writes and advance oscillators and envelopes,
+	* filters and resampler run normally over a short tail before the target to settle.
+	* The next #play continues at the very sample a straight play of that long reaches.
+	* Seeking backwards restarts the tune.
+	*
+	* @param ms position in milliseconds, as reported by #timeMs
+	*/
+	bool seekMs ( uint32_t ms );
+
+	/**
+	* Save the whole emulation state, C64 and SIDs, as a plain memory blob.
+	*
+	* @param snapshot the blob to fill
+	* @return false if no tune is loaded
+	*/
+	bool snapshot ( Snapshot& snapshot );
+
+	/**
+	* Restore a state saved by #snapshot.
+	* Only snapshots of the currently loaded tune taken with the same configuration are accepted.
+	*
+	* @param snapshot the blob to restore
+	* @return false if the snapshot doesn't fit, check #error for a detailed message
+	*/
+	bool restore ( const Snapshot& snapshot );
+
+	/**
+	* Capture the SID register writes, for analysis or re-rendering the SIDs alone.
+	* Attach before loading the tune, so the capture starts with the chip resets.
+	* The initial state passed to #loadTune is ignored while capturing,
+	* the initialisation is emulated instead to capture its writes.
+	*
+	* @param trace the trace to log to, nullptr stops capturing
+	*/
+	void setSidTrace ( SidTrace* trace );
+	[[ nodiscard ]] SidTrace* getSidTrace () const { return m_trace; }
 	[[ nodiscard ]] bool isPlaying () const { return m_isPlaying != state_t::STOPPED; }
 
 	[[ nodiscard ]] int getNumChips () const { return m_mixer.getNumChips (); }
 
+	/**
+	* Chip settings, applied to the current chips and kept for the tunes loaded later.
+	* Set them before #loadTune for the initialisation to run with them.
+	*/
 	void setCombinedWaveforms ( reSIDfp::CombinedWaveforms cws, const float threshold );
 
 	void set6581FilterCurve ( const double value );
@@ -112,7 +219,7 @@ public:
 	void setDacLeakage ( const double value );
 	void set6581VoiceDCDrift ( const double value );
 
-	[[ nodiscard ]] uint32_t timeMs () const { return m_c64.getTimeMs () - m_startTime; }				// Time in milliseconds
+	[[ nodiscard ]] uint32_t timeMs () const { return uint32_t ( ( ( m_c64.getTime () - m_startClock ) * 1000 ) / m_c64.getMainCpuSpeed () ); }	// Time in milliseconds
 
 	[[ nodiscard ]] const char* error () const { return m_errorString.c_str (); }
 
@@ -120,11 +227,64 @@ public:
 	void setBasic ( const uint8_t* rom );
 	void setChargen ( const uint8_t* rom );
 
-	[[ nodiscard ]] uint16_t getCia1TimerA () const { return m_c64.getCia1TimerA (); }
+	/**
+	* Get the programmed value of CIA 1 timer A, from the state of #getSidStatus.
+	* Wait-free and safe from any thread, also while another one plays.
+	*
+	* @return the value, or 0 if there's no state yet
+	*/
+	[[ nodiscard ]] uint16_t getCia1TimerA () const;
 
-	bool getSidStatus ( int sidNum, uint8_t regs[ 32 ] );
+	/**
+	* Get the state of the SIDs as of the end of the last #play, #seekMs, #restore or tune initialisation.
+	* Wait-free and safe from any thread, also while another one plays.
+	*
+	* @param status the state
+	* @return false if there's none yet
+	*/
+	bool getSidStatus ( SidStatus& status ) const { return m_status.read ( status ); }
 
-	[[ nodiscard ]] uint16_t getInterruptCycles () const { return m_c64.getInterruptCycles (); }
+	/**
+	* Get the registers last written to a SID along with the envelope levels of its voices
+	* at 0x1d-0x1f, from the state of #getSidStatus.
+	*/
+	bool getSidStatus ( int sidNum, uint8_t regs[ 32 ] ) const;
+
+	/**
+	* Get the cycles taken by the last interrupt of the tune, from the state of #getSidStatus.
+	* Wait-free and safe from any thread, also while another one plays.
+	*
+	* @return the cycles, or 0 if there's no state yet
+	*/
+	[[ nodiscard ]] uint16_t getInterruptCycles () const;
+
+	/**
+	* Capture the outputs of the voices and the filter of each SID while playing, for oscilloscopes,
+	* with each sample the average of the cycles it spans. Saves rendering the tune once per voice.
+	* While disabled, the chips are clocked without any extra work per cycle.
+	*
+	* @param rate sampling rate of the capture in Hertz, 0 disables it
+	* @param length samples kept per channel, rounded up to a power of two
+	*/
+	void setScope ( double rate, unsigned int length );
+
+	/**
+	* Copy out the latest captured samples, the oldest first, scaled to -1.0 .. 1.0.
+	* Call between the calls of #play, from the same thread.
+	*
+	* @param sidNum the chip
+	* @param channel 0 .. 2 for the voices, 3 for the filter output
+	* @param buffer output
+	* @param samples number of samples wanted
+	* @return number of samples copied, 0 if the chip doesn't exist or nothing is captured
+	*/
+	uint32_t getScope ( int sidNum, int channel, float* buffer, uint32_t samples ) const;
+
+	/**
+	* Get the number of samples captured per channel of a chip, wrapping around.
+	* The difference between two calls tells how many samples are new.
+	*/
+	[[ nodiscard ]] uint32_t getScopePosition ( int sidNum ) const;
 };
 
 }
@@ -22,6 +22,8 @@
 
 #include "sidemu.h"
 
+#include <cmath>
+
 namespace libsidplayfp
 {
 
@@ -41,6 +43,31 @@ void sidemu::reset ( uint8_t volume )
 	m_accessClk = 0;
 	m_sid.reset ();
 	m_sid.write ( 0x18, volume );
+
+	if ( m_trace )
+		m_trace->reset ( m_traceChip, volume );
+}
+//-----------------------------------------------------------------------------
+
+void sidemu::floatOutput ( bool enable )
+{
+	if ( m_floatOutput == enable )
+		return;
+
+	m_floatOutput = enable;
+
+	constexpr auto	MASK = OUTPUTBUFFERSIZE - 1;
+
+	if ( enable )
+	{
+		for ( auto i = m_readPos; i != m_writePos; i++ )
+			m_floatBuffer[ i & MASK ] = float ( m_buffer[ i & MASK ] ) * ( 1.0f / 32768.0f );
+	}
+	else
+	{
+		for ( auto i = m_readPos; i != m_writePos; i++ )
+			m_buffer[ i & MASK ] = reSIDfp::SoftClip::clip ( int ( std::lround ( m_floatBuffer[ i & MASK ] * 32768.0f ) ) );
+	}
 }
 //-----------------------------------------------------------------------------
 
@@ -21,6 +21,7 @@
 * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <algorithm>
 #include <string>
 
 #include "sidplayfp/SidConfig.h"
@@ -31,6 +32,8 @@
 
 #include "sidplayfp/residfp/SID.h"
 
+#include "sidtrace.h"
+
 #include "EZ/config.h"
 
 namespace libsidplayfp
@@ -46,40 +49,120 @@ private:
 
 	uint8_t			lastpoke[ 0x20 ] = {};
 
+	// Optional capture of the register accesses, along with our index in it
+	SidTrace*		m_trace = nullptr;
+	int				m_traceChip = 0;
+
+	void traceSetting ( SidTrace::setting_t id, double param, uint8_t arg = 0 )
+	{
+		if ( m_trace )
+			m_trace->setting ( m_accessClk, m_traceChip, id, arg, param );
+	}
+
 public:
 	// Bank functions
 	sidinline void poke ( uint16_t address, uint8_t value ) override
 	{
 		lastpoke[ address & 0x1f ] = value;
 		write ( address & 0x1f, value );
+
+		if ( m_trace )
+			m_trace->write ( m_accessClk, m_traceChip, address & 0x1f, value );
+	}
+	sidinline uint8_t peek ( uint16_t address ) override
+	{
+		const auto	value = read ( address & 0x1f );
+
+		if ( m_trace )
+			m_trace->read ( m_accessClk, m_traceChip, address & 0x1f, value );
+
+		return value;
 	}
-	sidinline uint8_t peek ( uint16_t address ) override { return read ( address & 0x1f ); }
 
 	void getStatus ( uint8_t regs[ 0x20 ] ) const { std::copy_n ( lastpoke, std::size ( lastpoke ), regs ); }
 
 	/**
-	* Buffer size. 5000 is roughly 5 ms at 96 kHz
+	* Size of the sample ring, a power of two. 8192 is roughly 85 ms at 96 kHz
 	*/
-	static constexpr auto	OUTPUTBUFFERSIZE = 5000u;
+	static constexpr auto	OUTPUTBUFFERSIZE = 8192u;
 
 protected:
+	/**
+	* Room past the end of the ring for the samples of one call of the chip,
+	* folded back to the start afterwards. There's at most one sample per cycle,
+	* so the chip is clocked in steps of at most this many cycles.
+	*/
+	static constexpr auto	SPARE = 1024u;
+
 	EventScheduler&	eventScheduler;
 
 	event_clock_t	m_accessClk = 0;
 
-	// The sample buffer
-	int16_t		m_buffer[ OUTPUTBUFFERSIZE ];
+	// The sample rings, the float one is in use for float output
+	int16_t		m_buffer[ OUTPUTBUFFERSIZE + SPARE ];
+	float		m_floatBuffer[ OUTPUTBUFFERSIZE + SPARE ];
+
+	bool	m_floatOutput = false;
+
+	// Free running positions of the next sample to write and to read, wrapped on access
+	uint32_t	m_writePos = 0;
+	uint32_t	m_readPos = 0;
 
-	// Current position in buffer
-	int	m_bufferpos = 0;
+	// Only advance the chip state, no samples are produced
+	bool	m_fastForward = false;
 
 	std::string m_error = "N/A";
 
+	/**
+	* Clock the chip into a ring.
+	*/
+	template<typename sample_t>
+	sidinline void produce ( sample_t* ring, unsigned int cycles )
+	{
+		const auto	pos = m_writePos & ( OUTPUTBUFFERSIZE - 1 );
+		const auto	count = uint32_t ( m_sid.clock ( cycles, ring + pos ) );
+
+		if ( pos + count > OUTPUTBUFFERSIZE )
+			std::copy ( ring + OUTPUTBUFFERSIZE, ring + pos + count, ring );
+
+		m_writePos += count;
+	}
+
+	/**
+	* Save or restore the samples not consumed yet, in up to two pieces of a ring.
+	*/
+	template<class Archive, typename sample_t>
+	void serializeRing ( Archive& ar, sample_t* ring )
+	{
+		const auto	count = std::min ( m_writePos - m_readPos, OUTPUTBUFFERSIZE );
+		const auto	offset = m_readPos & ( OUTPUTBUFFERSIZE - 1 );
+		const auto	first = std::min ( count, OUTPUTBUFFERSIZE - offset );
+
+		ar.array ( ring + offset, first );
+		ar.array ( ring, count - first );
+	}
+
 public:
 	sidemu ( EventScheduler& eventScheduler );
 
 	void reset ( uint8_t volume );
 
+	/**
+	* Save or restore the chip along with the samples not mixed yet.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( lastpoke, m_accessClk, m_writePos, m_readPos, m_floatOutput );
+
+		if ( m_floatOutput )
+			serializeRing ( ar, m_floatBuffer );
+		else
+			serializeRing ( ar, m_buffer );
+
+		m_sid.serialize ( ar );
+	}
+
 	/**
 	* Clock the SID chip
 	*/
@@ -87,21 +170,99 @@ public:
 	{
 		const event_clock_t	cycles = eventScheduler.getTime ( EVENT_CLOCK_PHI1 ) - m_accessClk;
 		m_accessClk += cycles;
-		m_bufferpos += m_sid.clock ( (unsigned int)cycles, m_buffer + m_bufferpos );
+
+		if ( m_fastForward )
+		{
+			// The samples skipped are never there to be read, they count as consumed along with the ones before
+			m_writePos += uint32_t ( m_sid.fastForward ( (unsigned int)cycles ) );
+			m_readPos = m_writePos;
+			return;
+		}
+
+		for ( auto left = (unsigned int)cycles; left; )
+		{
+			const auto	step = std::min ( left, SPARE );
+
+			if ( m_floatOutput )
+				produce ( m_floatBuffer, step );
+			else
+				produce ( m_buffer, step );
+
+			left -= step;
+		}
+	}
+
+	/**
+	* Produce float samples without clipping, instead of soft clipped int16_t ones.
+	* The samples not mixed yet are converted.
+	*/
+	void floatOutput ( bool enable );
+
+	/**
+	* Enable or disable fast forwarding, where the register writes are latched
+	* and oscillators and envelopes advance, but no samples are produced.
+	* The positions in the sample stream still advance as if they were.
+	*/
+	void fastForward ( bool enable )
+	{
+		m_fastForward = enable;
+
+		if ( m_trace )
+			m_trace->mode ( m_accessClk, m_traceChip, SidTrace::kind_t::FASTFORWARD, enable );
+	}
+
+	/**
+	* Settle the analog output faster, after fast forwarding.
+	*/
+	void settle ( bool enable )
+	{
+		m_sid.settle ( enable );
+
+		if ( m_trace )
+			m_trace->mode ( m_accessClk, m_traceChip, SidTrace::kind_t::SETTLE, enable );
 	}
 
+	/**
+	* Capture the register accesses into a trace, nullptr stops capturing.
+	*
+	* @param trace the trace to log to
+	* @param chip index of this chip in the trace
+	*/
+	void trace ( SidTrace* trace, int chip )	{	m_trace = trace;	m_traceChip = chip;	}
+
 	/**
 	* Set SID model.
 	*/
-	void model ( SidConfig::sid_model_t _model )	{	m_sid.setChipModel ( _model == SidConfig::MOS6581 ? reSIDfp::MOS6581 : reSIDfp::MOS8580 );	}
+	void model ( SidConfig::sid_model_t _model )
+	{
+		m_sid.setChipModel ( _model == SidConfig::MOS6581 ? reSIDfp::MOS6581 : reSIDfp::MOS8580 );
+		traceSetting ( SidTrace::setting_t::MODEL, 0.0, uint8_t ( _model ) );
+	}
 
 	/**
 	* Set the sampling method.
 	*
 	* @param systemfreq
 	* @param outputfreq
+	* @param method
 	*/
-	void sampling ( float systemfreq, float outputfreq )	{	m_sid.setSamplingParameters ( systemfreq, outputfreq );		}
+	void sampling ( float systemfreq, float outputfreq, SidConfig::sampling_method_t method = SidConfig::RESAMPLE )
+	{
+		auto getMethod = [] ( SidConfig::sampling_method_t method )
+		{
+			switch ( method )
+			{
+				case SidConfig::INTERPOLATE:	return reSIDfp::DECIMATE;
+				case SidConfig::RESAMPLE_FAST:	return reSIDfp::RESAMPLE_FAST;
+				case SidConfig::RESAMPLE_BLOCK:	return reSIDfp::RESAMPLE_BLOCK;
+				default:
+				case SidConfig::RESAMPLE:		return reSIDfp::RESAMPLE;
+			}
+		};
+
+		m_sid.setSamplingParameters ( systemfreq, outputfreq, getMethod ( method ) );
+		traceSetting ( SidTrace::setting_t::CPUFREQ, systemfreq, uint8_t ( method ) );
+	}
 
 	/**
 	* Get a detailed error message.
@@ -111,36 +272,73 @@ public:
 	[[ nodiscard ]] sidinline uint8_t read ( uint8_t addr ) 		{	clock ();	return m_sid.read ( addr );	}
 	sidinline void write ( uint8_t addr, uint8_t data ) 			{	clock ();	m_sid.write ( addr, data );	}
 
-	void combinedWaveforms ( reSIDfp::CombinedWaveforms cws, const float threshold )	{	m_sid.setCombinedWaveforms ( cws, threshold );	}
+	void combinedWaveforms ( reSIDfp::CombinedWaveforms cws, const float threshold )
+	{
+		m_sid.setCombinedWaveforms ( cws, threshold );
+		traceSetting ( SidTrace::setting_t::COMBINEDWAVEFORMS, threshold, uint8_t ( cws ) );
+	}
 
-	void filter6581Curve ( double filterCurve )			{	m_sid.setFilter6581Curve ( filterCurve );	}
-	void filter6581Range ( double adjustment )			{	m_sid.setFilter6581Range ( adjustment );	}
-	void filter6581Gain ( double adjustment )			{	m_sid.setFilter6581Gain ( adjustment );		}
+	void filter6581Curve ( double filterCurve )			{	m_sid.setFilter6581Curve ( filterCurve );	traceSetting ( SidTrace::setting_t::FILTER6581CURVE, filterCurve );		}
+	void filter6581Range ( double adjustment )			{	m_sid.setFilter6581Range ( adjustment );	traceSetting ( SidTrace::setting_t::FILTER6581RANGE, adjustment );		}
+	void filter6581Gain ( double adjustment )			{	m_sid.setFilter6581Gain ( adjustment );		traceSetting ( SidTrace::setting_t::FILTER6581GAIN, adjustment );		}
 
-	void filter6581Digi ( double adjustment )			{	m_sid.setFilter6581Digi ( adjustment );		}
+	void filter6581Digi ( double adjustment )			{	m_sid.setFilter6581Digi ( adjustment );		traceSetting ( SidTrace::setting_t::FILTER6581DIGI, adjustment );		}
 
-	void voice6581DCDrift ( double adjustment )			{	m_sid.setVoiceDCDrift ( adjustment );		}
+	void voice6581DCDrift ( double adjustment )			{	m_sid.setVoiceDCDrift ( adjustment );		traceSetting ( SidTrace::setting_t::VOICE6581DCDRIFT, adjustment );		}
 
-	void filter8580Curve ( double filterCurve )			{	m_sid.setFilter8580Curve ( filterCurve );	}
+	void filter8580Curve ( double filterCurve )			{	m_sid.setFilter8580Curve ( filterCurve );	traceSetting ( SidTrace::setting_t::FILTER8580CURVE, filterCurve );		}
 
-	void setDacLeakage ( const double leakage )			{	m_sid.setDacLeakage ( leakage );	}
+	void setDacLeakage ( const double leakage )			{	m_sid.setDacLeakage ( leakage );	traceSetting ( SidTrace::setting_t::DACLEAKAGE, leakage );	}
 
 	[[ nodiscard ]] float getInternalEnvValue ( int voiceNo ) const		{	return m_sid.getEnvLevel ( voiceNo );		}
+	[[ nodiscard ]] uint8_t getOsc3 () const								{	return m_sid.getOsc3 ();					}
+	[[ nodiscard ]] uint8_t getEnv3 () const								{	return m_sid.getEnv3 ();					}
+
+	/**
+	* Capture the voices and the filter output for oscilloscopes.
+	*
+	* @see reSIDfp::SID::setScope
+	*/
+	void scope ( double systemfreq, double rate, unsigned int length )	{	m_sid.setScope ( systemfreq, rate, length );	}
+
+	[[ nodiscard ]] uint32_t readScope ( int channel, float* buffer, uint32_t samples ) const	{	return m_sid.readScope ( channel, buffer, samples );	}
+	[[ nodiscard ]] uint32_t getScopePosition () const											{	return m_sid.getScopePosition ();						}
+
+	/**
+	* Get the number of samples produced and not consumed yet.
+	*/
+	[[ nodiscard ]] sidinline int samplesAvailable () const { return int ( m_writePos - m_readPos ); }
 
 	/**
-	* Get the current position in buffer.
+	* Get the offset of the next sample to consume in the ring.
+	* The samples available from there may wrap around the end of the ring.
 	*/
-	[[ nodiscard ]] sidinline int bufferpos () const { return m_bufferpos; }
+	[[ nodiscard ]] sidinline int readOffset () const { return int ( m_readPos & ( OUTPUTBUFFERSIZE - 1 ) ); }
 
 	/**
-	* Set the position in buffer.
+	* Get the number of samples consumed since the chip was created, wrapping around.
 	*/
-	void bufferpos ( int pos ) { m_bufferpos = pos; }
+	[[ nodiscard ]] sidinline uint32_t readPosition () const { return m_readPos; }
 
 	/**
-	* Get the buffer.
+	* Mark samples as consumed.
+	*/
+	sidinline void consume ( int count ) { m_readPos += uint32_t ( count ); }
+
+	/**
+	* Discard the samples not consumed yet.
+	*/
+	void discard () { m_readPos = m_writePos; }
+
+	/**
+	* Get the ring.
 	*/
 	[[ nodiscard ]] int16_t* buffer () { return &m_buffer[ 0 ]; }
+
+	/**
+	* Get the ring used for float output.
+	*/
+	[[ nodiscard ]] float* floatBuffer () { return &m_floatBuffer[ 0 ]; }
 };
 
 }
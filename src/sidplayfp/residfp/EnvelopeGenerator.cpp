@@ -23,11 +23,50 @@
 
 #include "EnvelopeGenerator.h"
 
+#include <algorithm>
+
 namespace reSIDfp
 {
 
 //-----------------------------------------------------------------------------
 
+/**
+* Sequence of the rate counter LFSR starting from its reset value,
+* along with the position of each value in it.
+*/
+class LfsrSequence final
+{
+public:
+	static constexpr auto	PERIOD = 0x7fffu;
+	static constexpr auto	NONE = 0xffffu;
+
+	uint16_t	value[ PERIOD ];
+	uint16_t	position[ 0x8000 ];
+
+	LfsrSequence ()
+	{
+		std::fill_n ( position, std::size ( position ), NONE );
+
+		auto	lfsr = 0x7fffu;
+		for ( auto i = 0u; i < PERIOD; i++ )
+		{
+			value[ i ] = uint16_t ( lfsr );
+			position[ lfsr ] = uint16_t ( i );
+
+			const auto	feedback = ( ( lfsr << 14 ) ^ ( lfsr << 13 ) ) & 0x4000;
+			lfsr = ( lfsr >> 1 ) | feedback;
+		}
+	}
+
+	static const LfsrSequence& get ()
+	{
+		static const LfsrSequence	sequence;
+		return sequence;
+	}
+};
+
+//-----------------------------------------------------------------------------
+
 void EnvelopeGenerator::reset ()
 {
 	// counter is not changed on reset
@@ -54,6 +93,38 @@ void EnvelopeGenerator::reset ()
 }
 //-----------------------------------------------------------------------------
 
+void EnvelopeGenerator::fastForward ( unsigned int cycles )
+{
+	const auto&	sequence = LfsrSequence::get ();
+
+	while ( cycles )
+	{
+		// Nothing but the rate counter runs until it matches the period
+		const auto	from = sequence.position[ lfsr & 0x7fff ];
+
+		if ( ! new_exponential_counter_period && ! state_pipeline && ! envelope_pipeline && ! exponential_pipeline && ! resetLfsr
+			&& lfsr != rate && from != LfsrSequence::NONE )
+		{
+			const auto	to = sequence.position[ rate & 0x7fff ];
+
+			auto	steps = cycles;
+
+			if ( to != LfsrSequence::NONE )
+				steps = std::min ( steps, ( to + LfsrSequence::PERIOD - from ) % LfsrSequence::PERIOD );
+
+			lfsr = sequence.value[ ( from + steps ) % LfsrSequence::PERIOD ];
+			env3 = envelope_counter;
+
+			cycles -= steps;
+			continue;
+		}
+
+		clock ();
+		cycles--;
+	}
+}
+//-----------------------------------------------------------------------------
+
 void EnvelopeGenerator::writeCONTROL_REG ( uint8_t control )
 {
 	const auto  gate_next = ( control & 0x01 ) != 0;
@@ -152,6 +152,14 @@ public:
 	*/
 	void clock ();
 
+	/**
+	* Advance the envelope as if clocked for a number of cycles,
+	* jumping the rate counter directly to its next match.
+	*
+	* @param cycles number of cycles
+	*/
+	void fastForward ( unsigned int cycles );
+
 	/**
 	* Get the Envelope Generator digital output.
 	*/
@@ -162,6 +170,17 @@ public:
 	*/
 	void reset ();
 
+	/**
+	* Save or restore the envelope state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( lfsr, rate, exponential_counter, exponential_counter_period, new_exponential_counter_period );
+		ar ( state_pipeline, envelope_pipeline, exponential_pipeline, state, next_state );
+		ar ( counter_enabled, gate, resetLfsr, envelope_counter, attack, decay, sustain, release, env3 );
+	}
+
 	/**
 	* Write control register.
 	*
@@ -71,6 +71,10 @@ private:
 
 	int w0hp_1_s17 = 0;
 
+	// High-pass coefficient, and a faster one to settle after fast forwarding
+	int w0hp_normal_s17 = 0;
+	int w0hp_settle_s17 = 0;
+
 public:
 	/**
 	* SID clocking.
@@ -110,9 +114,21 @@ public:
 
 		// High-pass: R = 10kOhm, C = 10uF;   w0h = dt/(dt+RC) = 1e-6/(1e-6+1e4*1e-5) = 0.00000999
 		// Cutoff 1/2*PI*RC = 1/2*PI*1e4*1e-5 = 1.59155 Hz
-		w0hp_1_s17 = int ( ( dt / ( dt + 10e3 * 10e-6 ) ) * ( 1 << 17 ) + 0.5 );
+		w0hp_normal_s17 = int ( ( dt / ( dt + 10e3 * 10e-6 ) ) * ( 1 << 17 ) + 0.5 );
+
+		// Settling: 16 times faster, which quickly charges C to the current DC level
+		w0hp_settle_s17 = int ( ( dt / ( dt + 10e3 * 10e-6 / 16 ) ) * ( 1 << 17 ) + 0.5 );
+
+		w0hp_1_s17 = w0hp_normal_s17;
 	}
 
+	/**
+	* Settle the high-pass filter faster, after its input has changed abruptly.
+	*
+	* @param enable true to speed up, false for normal operation
+	*/
+	void settle ( bool enable )	{	w0hp_1_s17 = enable ? w0hp_settle_s17 : w0hp_normal_s17;	}
+
 	/**
 	* SID reset.
 	*/
@@ -122,6 +138,12 @@ public:
 		Vlp = 0; //1 << (15 + 11);
 		Vhp = 0;
 	}
+
+	/**
+	* Save or restore the filter state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar ) { ar ( Vlp, Vhp ); }
 };
 
 } // namespace reSIDfp
@@ -30,7 +30,7 @@ namespace reSIDfp
 
 //-----------------------------------------------------------------------------
 
-Filter::Filter ( FilterModelConfig& _fmc )
+Filter::Filter ( const FilterModelConfig& _fmc )
 	: fmc ( _fmc )
 {
 	// Pre-calculate all possible summer/mixer combinations
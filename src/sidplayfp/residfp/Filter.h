@@ -33,24 +33,24 @@ namespace reSIDfp
 class Filter
 {
 protected:
-	FilterModelConfig&	fmc;
+	const FilterModelConfig&	fmc;
 
-	uint16_t**	mixer = nullptr;
-	uint16_t**	summer = nullptr;
-	uint16_t*	resonance = nullptr;
-	uint16_t*	volume = nullptr;
+	const uint16_t* const*	mixer = nullptr;
+	const uint16_t* const*	summer = nullptr;
+	const uint16_t*	resonance = nullptr;
+	const uint16_t*	volume = nullptr;
 
 	// Current volume amplifier setting.
-	uint16_t*	currentVolume = nullptr;
+	const uint16_t*	currentVolume = nullptr;
 
 	// Current filter/voice mixer setting.
-	uint16_t*	currentMixer = nullptr;
+	const uint16_t*	currentMixer = nullptr;
 
 	// Filter input summer setting.
-	uint16_t*	currentSummer = nullptr;
+	const uint16_t*	currentSummer = nullptr;
 
 	// Filter resonance value.
-	uint16_t*	currentResonance = nullptr;
+	const uint16_t*	currentResonance = nullptr;
 
 	// Filter highpass state
 	int Vhp = 0;
@@ -93,7 +93,7 @@ protected:
 	}
 
 public:
-	Filter ( FilterModelConfig& fmc );
+	Filter ( const FilterModelConfig& fmc );
 	virtual ~Filter () = default;
 
 	/**
@@ -101,6 +101,28 @@ public:
 	*/
 	void reset ();
 
+	/**
+	* Save or restore the filter state.
+	* Table pointers are rebuilt from the register values.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		auto	res = uint8_t ( ( currentResonance - resonance ) >> 16 );
+		auto	vol = uint8_t ( ( currentVolume - volume ) >> 16 );
+
+		ar ( fc, filterModeRouting, res, vol, Vhp, Vbp, Vlp, Ve );
+
+		if constexpr ( Archive::loading )
+		{
+			currentResonance = resonance + ( res << 16 );
+			currentVolume = volume + ( vol << 16 );
+
+			updatedCenterFrequency ();
+			updateMixing ();
+		}
+	}
+
 	/**
 	* Write Frequency Cutoff Low register.
 	*
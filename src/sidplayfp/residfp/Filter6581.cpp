@@ -33,6 +33,7 @@ Filter6581::Filter6581 ()
 	, hpIntegrator ( fmc6581 )
 	, bpIntegrator ( fmc6581 )
 {
+	setVoiceDCDrift ( 1.0 );
 	setFilterCurve ( 0.5f );
 
 	updatedCenterFrequency ();
@@ -51,7 +52,10 @@ void Filter6581::setFilterCurve ( double curvePosition )
 
 void Filter6581::setFilterRange ( double adjustment )
 {
-	fmc6581.setFilterRange ( adjustment );
+	const auto	uCox = FilterModelConfig6581::getRangeUCox ( adjustment );
+
+	hpIntegrator.setUCox ( uCox );
+	bpIntegrator.setUCox ( uCox );
 }
 //-----------------------------------------------------------------------------
 
@@ -63,13 +67,13 @@ void Filter6581::setFilterGain ( double adjustment )
 
 void Filter6581::setDigiVolume ( double adjustment )
 {
-	Ve = int16_t ( adjustment * fmc6581.getNormalizedVoice ( 0.0f, 0 ) );
+	Ve = int16_t ( adjustment * fmc6581.getNormalizedVoice ( 0.0f, voiceDC[ 0 ] ) );
 }
 //-----------------------------------------------------------------------------
 
 void Filter6581::setVoiceDCDrift ( double adjustment )
 {
-	fmc6581.setVoiceDCDrift ( adjustment );
+	fmc6581.getVoiceDC ( adjustment, voiceDC );
 }
 //-----------------------------------------------------------------------------
 
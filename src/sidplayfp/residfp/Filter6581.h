@@ -315,7 +315,7 @@ namespace reSIDfp
 class Filter6581 final : public Filter
 {
 private:
-	FilterModelConfig6581&	fmc6581;
+	const FilterModelConfig6581&	fmc6581;
 
 	const uint16_t* f0_dac = nullptr;
 
@@ -324,6 +324,9 @@ private:
 
 	int	filterGain = int ( 0.92 * ( 1 << 12 ) );	// Filter gain
 
+	// Voice DC offset per envelope value, set by the voice DC drift
+	double	voiceDC[ 256 ];
+
 protected:
 	/**
 	* Set filter cutoff frequency.
@@ -344,6 +347,18 @@ public:
 		delete[] f0_dac;
 	}
 
+	/**
+	* Save or restore the filter state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		hpIntegrator.serialize ( ar );
+		bpIntegrator.serialize ( ar );
+
+		Filter::serialize ( ar );
+	}
+
 	[[ nodiscard ]] sidinline uint16_t clock ( float voice1, float voice2, float voice3, uint8_t env1, uint8_t env2, uint8_t env3 )
 	{
 		// index 0 = unfiltered, index 1 = filtered
@@ -353,9 +368,9 @@ public:
 		{
 			const auto	fltMd = filterModeRouting & 0xF;
 
-			Vsum[ fltMd & 1 ]			 = fmc6581.getNormalizedVoice ( voice1, env1 );
-			Vsum[ ( fltMd >> 1 ) & 1 ]	+= fmc6581.getNormalizedVoice ( voice2, env2 );
-			Vsum[ ( fltMd >> 2 ) & 1 ]	+= fmc6581.getNormalizedVoice ( voice3, env3 ) & voice3Mask;
+			Vsum[ fltMd & 1 ]			 = fmc6581.getNormalizedVoice ( voice1, voiceDC[ env1 ] );
+			Vsum[ ( fltMd >> 1 ) & 1 ]	+= fmc6581.getNormalizedVoice ( voice2, voiceDC[ env2 ] );
+			Vsum[ ( fltMd >> 2 ) & 1 ]	+= fmc6581.getNormalizedVoice ( voice3, voiceDC[ env3 ] ) & voice3Mask;
 			Vsum[ fltMd >> 3 ]			+= Ve;
 		}
 
@@ -418,7 +433,7 @@ public:
 	*
 	* @param input a signed 16 bit sample
 	*/
-	void input ( int16_t _input ) { Ve = fmc6581.getNormalizedVoice ( _input / 32768.0f, 0 ); }
+	void input ( int16_t _input ) { Ve = fmc6581.getNormalizedVoice ( _input / 32768.0f, voiceDC[ 0 ] ); }
 };
 
 
@@ -272,7 +272,7 @@ namespace reSIDfp
 class Filter8580 final : public Filter
 {
 private:
-	FilterModelConfig8580&	fmc8580;
+	const FilterModelConfig8580&	fmc8580;
 
 	Integrator8580	hpIntegrator;	// VCR + associated capacitor connected to highpass output.
 	Integrator8580	bpIntegrator;	// VCR + associated capacitor connected to bandpass output.
@@ -294,6 +294,18 @@ protected:
 public:
 	Filter8580 ();
 
+	/**
+	* Save or restore the filter state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		hpIntegrator.serialize ( ar );
+		bpIntegrator.serialize ( ar );
+
+		Filter::serialize ( ar );
+	}
+
 	[[ nodiscard ]] sidinline uint16_t clock ( float voice1, float voice2, float voice3 )
 	{
 		// index 0 = unfiltered, index 1 = filtered
@@ -32,12 +32,14 @@ FilterModelConfig::FilterModelConfig ( double vvr, double c, double vdd, double
 	, Vdd ( vdd )
 	, Vth ( vth )
 	, Vddt ( Vdd - Vth )
+	, uCox ( ucox )
 	, vmin ( opamp_voltage[ 0 ].x )
 	, vmax ( std::max ( Vddt, opamp_voltage[ 0 ].y ) )
 	, denorm ( vmax - vmin )
 	, norm ( 1.0 / denorm )
 	, N16 ( norm * ( ( 1 << 16 ) - 1 ) )
 	, voice_voltage_range ( vvr )
+	, currFactorCoeff ( denorm * ( uCox / 2.0 * 1.0e-6 / C ) )
 {
 	// Generate random noise for dithering
 	{
@@ -48,8 +50,33 @@ FilterModelConfig::FilterModelConfig ( double vvr, double c, double vdd, double
 			buf = unif ( re );
 	}
 
-	setUCox ( ucox );
+	// The tables depend on all of the above and on the noise, which depends on the standard library
+	{
+		const double	params[] = { vvr, c, vdd, vth, ucox };
+
+		modelHash = TableCache::getHash ( params, sizeof ( params ) );
+		modelHash = TableCache::getHash ( opamp_voltage, opamp_size * sizeof ( Spline::Point ), modelHash );
+		modelHash = TableCache::getHash ( rndBuffer, sizeof ( rndBuffer ), modelHash );
+	}
+}
+//-----------------------------------------------------------------------------
+
+void FilterModelConfig::setTables ( tables_t& tables )
+{
+	uint16_t*	mixers[ 8 ] = { tables.mixer0, tables.mixer1, tables.mixer2, tables.mixer3, tables.mixer4, tables.mixer5, tables.mixer6, tables.mixer7 };
+	uint16_t*	summers[ 5 ] = { tables.summer2, tables.summer3, tables.summer4, tables.summer5, tables.summer6 };
+
+	std::copy ( std::begin ( mixers ), std::end ( mixers ), mixer );
+	std::copy ( std::begin ( summers ), std::end ( summers ), summer );
 
+	volume = tables.volume;
+	resonance = tables.resonance;
+	opamp_rev = tables.opamp_rev;
+}
+//-----------------------------------------------------------------------------
+
+void FilterModelConfig::buildOpampRevTable ( const Spline::Point* opamp_voltage, int opamp_size )
+{
 	// Convert op-amp voltage transfer to 16 bit values
 	std::vector<Spline::Point> scaled_voltage ( opamp_size );
 
@@ -76,13 +103,6 @@ FilterModelConfig::FilterModelConfig ( double vvr, double c, double vdd, double
 }
 //-----------------------------------------------------------------------------
 
-void FilterModelConfig::setUCox ( double new_uCox )
-{
-	uCox = new_uCox;
-	currFactorCoeff = denorm * ( uCox / 2.0 * 1.0e-6 / C );
-}
-//-----------------------------------------------------------------------------
-
 void FilterModelConfig::buildSummerTable ( OpAmp& opampModel )
 {
 	// The filter summer operates at n ~ 1, and has 5 fundamentally different
@@ -93,6 +113,7 @@ void FilterModelConfig::buildSummerTable ( OpAmp& opampModel )
 	// and transistors are not linear components. However modeling all
 	// transistors separately would be extremely costly.
 	const auto	r_N16 = 1.0 / N16;
+	auto		rndIndex = 0;
 
 	for ( auto i = 0; i < 5; i++ )
 	{
@@ -106,7 +127,7 @@ void FilterModelConfig::buildSummerTable ( OpAmp& opampModel )
 		for ( auto vi = 0; vi < size; vi++ )
 		{
 			const auto	vin = vmin + vi * r_N16 * r_idiv;	// vmin .. vmax
-			summer[ i ][ vi ] = getNormalizedValue ( opampModel.solve ( n, vin ) );
+			summer[ i ][ vi ] = getNormalizedValue ( opampModel.solve ( n, vin ), rndIndex );
 		}
 	}
 }
@@ -120,6 +141,7 @@ void FilterModelConfig::buildMixerTable ( OpAmp& opampModel, double nRatio )
 	// All "on", transistors are modeled as one - see comments above for
 	// the filter summer.
 	const auto	r_N16 = 1.0 / N16;
+	auto		rndIndex = 0;
 
 	for ( auto i = 0; i < 8; i++ )
 	{
@@ -133,7 +155,7 @@ void FilterModelConfig::buildMixerTable ( OpAmp& opampModel, double nRatio )
 		for ( auto vi = 0; vi < size; vi++ )
 		{
 			const auto	vin = vmin + vi * r_N16 * r_idiv;	// vmin .. vmax
-			mixer[ i ][ vi ] = getNormalizedValue ( opampModel.solve ( n, vin ) );
+			mixer[ i ][ vi ] = getNormalizedValue ( opampModel.solve ( n, vin ), rndIndex );
 		}
 	}
 }
@@ -145,6 +167,7 @@ void FilterModelConfig::buildVolumeTable ( OpAmp& opampModel, double nDivisor )
 	// From die photographs of the volume "resistor" ladders it follows that
 	// gain ~ vol/12 (assuming ideal op-amps and ideal "resistors").
 	const auto	r_N16 = 1.0 / N16;
+	auto		rndIndex = 0;
 
 	for ( auto n8 = 0; n8 < 16; n8++ )
 	{
@@ -156,7 +179,7 @@ void FilterModelConfig::buildVolumeTable ( OpAmp& opampModel, double nDivisor )
 		for ( auto vi = 0; vi < size; vi++ )
 		{
 			const auto	vin = vmin + vi * r_N16; // vmin .. vmax
-			volume[ n8 ][ vi ] = getNormalizedValue ( opampModel.solve ( n, vin ) );
+			volume[ n8 ][ vi ] = getNormalizedValue ( opampModel.solve ( n, vin ), rndIndex );
 		}
 	}
 }
@@ -165,6 +188,7 @@ void FilterModelConfig::buildVolumeTable ( OpAmp& opampModel, double nDivisor )
 void FilterModelConfig::buildResonanceTable ( OpAmp& opampModel, const double resonance_n[ 16 ] )
 {
 	const auto	r_N16 = 1.0 / N16;
+	auto		rndIndex = 0;
 
 	for ( auto n8 = 0; n8 < 16; n8++ )
 	{
@@ -174,7 +198,7 @@ void FilterModelConfig::buildResonanceTable ( OpAmp& opampModel, const double re
 		for ( auto vi = 0; vi < size; vi++ )
 		{
 			const auto	vin = vmin + vi * r_N16;	// vmin .. vmax
-			resonance[ n8 ][ vi ] = getNormalizedValue ( opampModel.solve ( resonance_n[ n8 ], vin ) );
+			resonance[ n8 ][ vi ] = getNormalizedValue ( opampModel.solve ( resonance_n[ n8 ], vin ), rndIndex );
 		}
 	}
 }
@@ -27,6 +27,7 @@
 
 #include "Spline.h"
 #include "OpAmp.h"
+#include "TableCache.h"
 
 namespace reSIDfp
 {
@@ -45,7 +46,7 @@ protected:
 	const double Vdd;			//< Positive supply voltage
 	const double Vth;			//< Threshold voltage
 	const double Vddt;			//< Vdd - Vth
-	double uCox;				//< Transconductance coefficient: u*Cox
+	const double uCox;			//< Transconductance coefficient: u*Cox, default of the chip
 	//@}
 
 	// Derived stuff
@@ -57,48 +58,65 @@ protected:
 
 	const double voice_voltage_range;
 
-	// Current factor coefficient for op-amp integrators
-	double currFactorCoeff;
+	// Current factor coefficient for op-amp integrators, at the default u*Cox
+	const double currFactorCoeff;
+
+	/**
+	* Lookup tables, in one block which is either built or mapped from the #TableCache.
+	* The models with more tables extend it.
+	*/
+	struct tables_t
+	{
+		// Gain and summer op-amps in output stage / filter
+		//@{
+		uint16_t	mixer0[ 1 ];
+		uint16_t	mixer1[ 1 << 16 ];
+		uint16_t	mixer2[ 2 << 16 ];
+		uint16_t	mixer3[ 3 << 16 ];
+		uint16_t	mixer4[ 4 << 16 ];
+		uint16_t	mixer5[ 5 << 16 ];
+		uint16_t	mixer6[ 6 << 16 ];
+		uint16_t	mixer7[ 7 << 16 ];
+
+		uint16_t	summer2[ 2 << 16 ];
+		uint16_t	summer3[ 3 << 16 ];
+		uint16_t	summer4[ 4 << 16 ];
+		uint16_t	summer5[ 5 << 16 ];
+		uint16_t	summer6[ 6 << 16 ];
+
+		uint16_t	volume[ 16 ][ 1 << 16 ];
+		uint16_t	resonance[ 16 ][ 1 << 16 ];
+		//@}
+
+		// Reverse op-amp transfer function
+		uint16_t	opamp_rev[ 1 << 16 ];
+	};
 
 	// Lookup tables for gain and summer op-amps in output stage / filter
 	//@{
-	uint16_t	mixer0[ 1 ];				//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	mixer1[ 1 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	mixer2[ 2 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	mixer3[ 3 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	mixer4[ 4 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	mixer5[ 5 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	mixer6[ 6 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	mixer7[ 7 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-
-	uint16_t*	mixer[ 8 ] = { mixer0, mixer1, mixer2, mixer3, mixer4, mixer5, mixer6, mixer7 };
-
-	uint16_t	summer2[ 2 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	summer3[ 3 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	summer4[ 4 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	summer5[ 5 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	summer6[ 6 << 16 ];			//-V730_NOINIT this is initialized in the derived class constructor
-
-	uint16_t*	summer[ 5 ] = { summer2, summer3, summer4, summer5, summer6 };
-
-	uint16_t	volume[ 16 ][1 << 16];		//-V730_NOINIT this is initialized in the derived class constructor
-	uint16_t	resonance[ 16 ][ 1 << 16];	//-V730_NOINIT this is initialized in the derived class constructor
+	uint16_t*	mixer[ 8 ] = {};
+	uint16_t*	summer[ 5 ] = {};
+
+	uint16_t	( *volume )[ 1 << 16 ] = nullptr;
+	uint16_t	( *resonance )[ 1 << 16 ] = nullptr;
 	//@}
 
 	// Reverse op-amp transfer function
-	uint16_t	opamp_rev[ 1 << 16 ];	//-V730_NOINIT this is initialized in the derived class constructor
+	uint16_t*	opamp_rev = nullptr;
 
 private:
- 	double			rndBuffer[ 4096 ];
- 	mutable int		rndIndex = 0;
+	// Noise for dithering, each user keeps its own index so the result doesn't depend on the order
+ 	double	rndBuffer[ 4096 ];
+
+	// Hash of the parameters of the model, for the table cache
+	uint64_t	modelHash;
+
+	TableCache	tableCache;
 
 	FilterModelConfig ( const FilterModelConfig& ) = delete;
 	FilterModelConfig& operator= ( const FilterModelConfig& ) = delete;
 
 protected:
-	// Voice DC offset LUT
-	double	voiceDC[ 256 ];
-
 	/**
 	* @param vvr voice voltage range
 	* @param vdv voice DC voltage
@@ -112,27 +130,51 @@ protected:
 	FilterModelConfig ( double vvr, double c, double vdd, double vth, double ucox, const Spline::Point* opamp_voltage, int opamp_size );
 	~FilterModelConfig () = default;
 
-	void setUCox ( double new_uCox );
+	/**
+	* Get the tables from the cache, or the memory to build them in.
+	*
+	* @param tables the tables of the model, extending #tables_t
+	* @param name model name, for the cache file
+	* @param hash hash of the parameters of the model not known here
+	* @return true if the tables are ready, false if they must be built
+	*/
+	template<typename T>
+	[[ nodiscard ]] bool openTables ( T*& tables, const char* name, uint64_t hash )
+	{
+		const auto	ready = tableCache.open ( name, TableCache::getHash ( &hash, sizeof ( hash ), modelHash ), sizeof ( T ) );
+
+		tables = static_cast<T*> ( tableCache.data () );
+		setTables ( *tables );
+
+		return ready;
+	}
+
+	/**
+	* Write the built tables to the cache.
+	*/
+	void storeTables () const { tableCache.store (); }
+
+	void setTables ( tables_t& tables );
 
+	void buildOpampRevTable ( const Spline::Point* opamp_voltage, int opamp_size );
 	void buildSummerTable ( OpAmp& opAmp );
 	void buildMixerTable ( OpAmp& opampModel, double nRatio );
 	void buildVolumeTable ( OpAmp& opampModel, double nDivisor );
 	void buildResonanceTable ( OpAmp& opampModel, const double resonance_n[ 16 ] );
 
 public:
-	[[ nodiscard ]] uint16_t* getVolume () { return &volume[ 0 ][ 0 ]; }
-	[[ nodiscard ]] uint16_t* getResonance () { return &resonance[ 0 ][ 0 ]; }
-	[[ nodiscard ]] uint16_t** getSummer () { return summer; }
-	[[ nodiscard ]] uint16_t** getMixer () { return mixer; }
-
-	void setVoiceDCVoltage ( double voltage );
+	[[ nodiscard ]] const uint16_t* getVolume () const { return &volume[ 0 ][ 0 ]; }
+	[[ nodiscard ]] const uint16_t* getResonance () const { return &resonance[ 0 ][ 0 ]; }
+	[[ nodiscard ]] const uint16_t* const* getSummer () const { return summer; }
+	[[ nodiscard ]] const uint16_t* const* getMixer () const { return mixer; }
 
 	[[ nodiscard ]] sidinline uint16_t getOpampRev ( int i ) const { return opamp_rev[ i ]; }
 	[[ nodiscard ]] sidinline double getVddt () const { return Vddt; }
 	[[ nodiscard ]] sidinline double getVth () const { return Vth; }
+	[[ nodiscard ]] sidinline double getUCox () const { return uCox; }
 
 	// helper functions
-	[[ nodiscard ]] sidinline uint16_t getNormalizedValue ( double value ) const
+	[[ nodiscard ]] sidinline uint16_t getNormalizedValue ( double value, int& rndIndex ) const
 	{
 		// This function does not get called in real-time, so we can afford to be a bit more accurate
 		const auto	tmp = N16 * ( value - vmin ) + rndBuffer[ rndIndex++ & 4095 ];
@@ -141,6 +183,18 @@ public:
  		return uint16_t ( tmp );
 	}
 
+	/**
+	* Like #getNormalizedValue, rounded instead of dithered,
+	* for the voltages of each chip which must not depend on how many chips were set up before.
+	*/
+	[[ nodiscard ]] sidinline uint16_t getNormalizedValueRounded ( double value ) const
+	{
+		const auto	tmp = N16 * ( value - vmin ) + 0.5;
+
+		assert ( tmp >= 0.0 && tmp < 65536.0 );
+		return uint16_t ( tmp );
+	}
+
 	template<int N> 
 	[[ nodiscard ]] sidinline uint16_t getNormalizedCurrentFactor ( double wl ) const
 	{
@@ -149,6 +203,17 @@ public:
 		return uint16_t ( tmp );
 	}
 
+	/**
+	* Like above, for a u*Cox set on the filter instead of the default one.
+	*/
+	template<int N> 
+	[[ nodiscard ]] sidinline uint16_t getNormalizedCurrentFactor ( double wl, double _uCox ) const
+	{
+		const auto	tmp = ( 1 << N ) * ( denorm * ( _uCox / 2.0 * 1.0e-6 / C ) ) * wl;
+		assert ( tmp >= 0.0 && tmp < 65536.0 );
+		return uint16_t ( tmp );
+	}
+
 	[[ nodiscard ]] sidinline uint16_t getNVmin () const
 	{
 		const auto	tmp = N16 * vmin;
@@ -36,6 +36,9 @@ namespace reSIDfp
 constexpr auto	DAC_BITS = 11u;
 constexpr auto	OPAMP_SIZE_6581 = 33u;
 
+constexpr auto	MIXER_N_RATIO = 8.0 / 6.0;
+constexpr auto	VOLUME_N_DIVISOR = 12.0;
+
 /**
 * This is the SID 6581 op-amp voltage transfer function, measured on
 * CAP1B/CAP1A on a chip marked MOS 6581R4AR 0687 14.
@@ -80,33 +83,24 @@ constexpr Spline::Point opamp_voltage_6581[ OPAMP_SIZE_6581 ] =
 };
 //-----------------------------------------------------------------------------
 
-static thread_local std::unique_ptr<FilterModelConfig6581>	instance;
-
-FilterModelConfig6581* FilterModelConfig6581::getInstance ()
+const FilterModelConfig6581* FilterModelConfig6581::getInstance ()
 {
-	if ( ! instance.get () )
-		instance.reset ( new FilterModelConfig6581 () );
+	static const std::unique_ptr<const FilterModelConfig6581>	instance ( new FilterModelConfig6581 () );
 
 	return instance.get ();
 }
 //-----------------------------------------------------------------------------
 
-void FilterModelConfig6581::setFilterRange ( double adjustment )
+double FilterModelConfig6581::getRangeUCox ( double adjustment )
 {
 	adjustment = std::clamp ( adjustment, 0.0, 1.0 );
 
-	// Get the new uCox value, in the range [1,40]
-	const auto	new_uCox = ( 1.0 + 39.0 * adjustment ) * 1e-6;
-
-	// Ignore small changes
-	if ( std::abs ( uCox - new_uCox ) < 1e-12 )
-		return;
-
-	setUCox ( new_uCox );
+	// In the range [1,40]
+	return ( 1.0 + 39.0 * adjustment ) * 1e-6;
 }
 //-----------------------------------------------------------------------------
 
-void FilterModelConfig6581::setVoiceDCDrift ( double drift )
+void FilterModelConfig6581::getVoiceDC ( double drift, double voiceDC[ 256 ] ) const
 {
 	/**
 	* On 6581 the DC offset varies between ~5.0V and ~5.214V depending on
@@ -138,7 +132,19 @@ FilterModelConfig6581::FilterModelConfig6581 ()
 {
 	dac.kinkedDac ( true );
 
-	setVoiceDCDrift ( 1.0 );
+	// The parameters of the tables not known to the base class
+	const double	params[] = { WL_vcr, MIXER_N_RATIO, VOLUME_N_DIVISOR };
+
+	tables6581_t*	tables;
+	const auto		ready = openTables ( tables, "6581", TableCache::getHash ( params, sizeof ( params ) ) );
+
+	vcr_nVg = tables->vcr_nVg;
+	vcr_n_Ids_term = tables->vcr_n_Ids_term;
+
+	if ( ready )
+		return;
+
+	buildOpampRevTable ( opamp_voltage_6581, OPAMP_SIZE_6581 );
 
 	// Create lookup tables for gains / summers
 	auto clBuildSummerTable = [ this ]
@@ -149,12 +155,12 @@ FilterModelConfig6581::FilterModelConfig6581 ()
 	auto clBuildMixerTable = [ this ]
 	{
 		OpAmp   opampModel ( std::vector<Spline::Point> ( std::begin ( opamp_voltage_6581 ), std::end ( opamp_voltage_6581 ) ), Vddt, vmin, vmax );
-		buildMixerTable ( opampModel, 8.0 / 6.0 );
+		buildMixerTable ( opampModel, MIXER_N_RATIO );
 	};
 	auto clBuildVolumeTable = [ this ]
 	{
 		OpAmp   opampModel ( std::vector<Spline::Point> ( std::begin ( opamp_voltage_6581 ), std::end ( opamp_voltage_6581 ) ), Vddt, vmin, vmax );
-		buildVolumeTable ( opampModel, 12.0 );
+		buildVolumeTable ( opampModel, VOLUME_N_DIVISOR );
 	};
 	auto clBuildResonanceTable = [ this ]
 	{
@@ -167,7 +173,7 @@ FilterModelConfig6581::FilterModelConfig6581 ()
 
 		buildResonanceTable ( opampModel, resonance_n );
 	};
-	auto clFilterVcrVg = [ this ]
+	auto clFilterVcrVg = [ this, tables ]
 	{
 		const auto  nVddt = N16 * ( Vddt - vmin );
 
@@ -177,10 +183,10 @@ FilterModelConfig6581::FilterModelConfig6581 ()
 			// 16 bits; the argument to sqrt is thus multiplied by (1 << 16).
 			const auto  tmp = nVddt - std::sqrt ( double ( i << 16 ) );
 			assert ( tmp > -0.5 && tmp < 65535.5 );
-			vcr_nVg[ i ] = uint16_t ( tmp + 0.5 );
+			tables->vcr_nVg[ i ] = uint16_t ( tmp + 0.5 );
 		}
 	};
-	auto clFilterVcrIds = [ this ]
+	auto clFilterVcrIds = [ this, tables ]
 	{
 		//  EKV model:
 		//
@@ -205,16 +211,21 @@ FilterModelConfig6581::FilterModelConfig6581 ()
 			const auto	kVgt_Vx = i - ( 1 << 15 );
 			const auto	log_term = std::log1p ( std::exp ( kVgt_Vx * r_N16_2Ut ) );
 			// Scaled by m*2^15
-			vcr_n_Ids_term[ i ] = n_Is * log_term * log_term;
+			tables->vcr_n_Ids_term[ i ] = n_Is * log_term * log_term;
 		}
 	};
 
-	auto	thdSummer = std::jthread ( clBuildSummerTable );
-	auto	thdMixer = std::jthread ( clBuildMixerTable );
-	auto	thdVolume = std::jthread ( clBuildVolumeTable );
-	auto	thdResonance = std::jthread ( clBuildResonanceTable );
-	auto	thdFilterVcrVg = std::jthread ( clFilterVcrVg );
-	auto	thdFilterVcrIds = std::jthread ( clFilterVcrIds );
+	{
+		auto	thdSummer = std::jthread ( clBuildSummerTable );
+		auto	thdMixer = std::jthread ( clBuildMixerTable );
+		auto	thdVolume = std::jthread ( clBuildVolumeTable );
+		auto	thdResonance = std::jthread ( clBuildResonanceTable );
+		auto	thdFilterVcrVg = std::jthread ( clFilterVcrVg );
+		auto	thdFilterVcrIds = std::jthread ( clFilterVcrIds );
+	}
+
+	// Once all threads are done
+	storeTables ();
 }
 //-----------------------------------------------------------------------------
 
@@ -223,9 +234,10 @@ uint16_t* FilterModelConfig6581::getDAC ( double adjustment ) const
 	const auto  _dac_zero = getDacZero ( adjustment );
 
 	auto    f0_dac = new uint16_t[ 1 << DAC_BITS ];
+	auto	rndIndex = 0;
 
 	for ( auto i = 0u; i < ( 1 << DAC_BITS ); i++ )
-		f0_dac[ i ] = getNormalizedValue ( _dac_zero + dac.getOutput ( i ) * dac_scale );
+		f0_dac[ i ] = getNormalizedValue ( _dac_zero + dac.getOutput ( i ) * dac_scale, rndIndex );
 
 	return f0_dac;
 }
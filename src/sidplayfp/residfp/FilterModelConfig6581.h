@@ -57,10 +57,19 @@ private:
 	// DAC lookup table
 	Dac	dac;
 
+	struct tables6581_t : tables_t
+	{
+		// VCR - 6581 only.
+		//@{
+		uint16_t	vcr_nVg[ 1 << 16 ];
+		double		vcr_n_Ids_term[ 1 << 16 ];
+		//@}
+	};
+
 	// VCR - 6581 only.
 	//@{
-	uint16_t	vcr_nVg[ 1 << 16 ];
-	double		vcr_n_Ids_term[ 1 << 16 ];
+	const uint16_t*	vcr_nVg = nullptr;
+	const double*	vcr_n_Ids_term = nullptr;
 	//@}
 
 	[[ nodiscard ]] sidinline double getDacZero ( double adjustment ) const	{	return dac_zero + adjustment;	}
@@ -68,11 +77,25 @@ private:
 public:
 	FilterModelConfig6581 ();
 
-	[[ nodiscard ]] static FilterModelConfig6581* getInstance ();
+	/**
+	* The tables are built once per process and shared read-only by all filters.
+	*/
+	[[ nodiscard ]] static const FilterModelConfig6581* getInstance ();
 
-	void setFilterRange ( double adjustment );
+	/**
+	* Get the u*Cox of a filter range.
+	*
+	* @param adjustment 0 .. 1
+	*/
+	[[ nodiscard ]] static double getRangeUCox ( double adjustment );
 
-	void setVoiceDCDrift ( double drift );
+	/**
+	* Build the voice DC offsets, per envelope value.
+	*
+	* @param drift 0 .. 1
+	* @param voiceDC the 256 offsets
+	*/
+	void getVoiceDC ( double drift, double voiceDC[ 256 ] ) const;
 
 	/**
 	* Construct an 11 bit cutoff frequency DAC output voltage table.
@@ -86,11 +109,11 @@ public:
 	[[ nodiscard ]] double getWL_snake () const { return WL_snake; }
 
 	[[ nodiscard ]] sidinline uint16_t getVcr_nVg ( const int i )		 const	{	return vcr_nVg[ i ]; }
-	[[ nodiscard ]] sidinline uint16_t getVcr_n_Ids_term ( const int i ) const	{	return uint16_t ( vcr_n_Ids_term[ i ] * uCox ); }
+	[[ nodiscard ]] sidinline uint16_t getVcr_n_Ids_term ( const int i, double _uCox ) const	{	return uint16_t ( vcr_n_Ids_term[ i ] * _uCox ); }
 
-	[[ nodiscard ]] sidinline int getNormalizedVoice ( float value, unsigned int env ) const
+	[[ nodiscard ]] sidinline int getNormalizedVoice ( float value, double voiceDC ) const
 	{
-		const auto	tmp = N16 * ( ( value * voice_voltage_range + voiceDC[ env ] ) - vmin );
+		const auto	tmp = N16 * ( ( value * voice_voltage_range + voiceDC ) - vmin );
 
 		assert ( tmp >= 0.0 && tmp < 65536.0 );
 		return int ( tmp );
@@ -80,6 +80,9 @@ constexpr double resGain[ 16 ] =
 
 constexpr auto	OPAMP_SIZE_8580 = 21u;
 
+constexpr auto	MIXER_N_RATIO = 8.0 / 5.0;
+constexpr auto	VOLUME_N_DIVISOR = 16.0;
+
 /**
 * This is the SID 8580 op-amp voltage transfer function, measured on
 * CAP1B/CAP1A on a chip marked CSG 8580R5 1690 25.
@@ -110,12 +113,9 @@ constexpr Spline::Point opamp_voltage_8580[ OPAMP_SIZE_8580 ] =
 };
 //-----------------------------------------------------------------------------
 
-static thread_local std::unique_ptr<FilterModelConfig8580>	instance;
-
-FilterModelConfig8580* FilterModelConfig8580::getInstance ()
+const FilterModelConfig8580* FilterModelConfig8580::getInstance ()
 {
-	if ( ! instance.get () )
-		instance.reset ( new FilterModelConfig8580 () );
+	static const std::unique_ptr<const FilterModelConfig8580>	instance ( new FilterModelConfig8580 () );
 
 	return instance.get ();
 }
@@ -132,7 +132,15 @@ FilterModelConfig8580::FilterModelConfig8580 () :
 		OPAMP_SIZE_8580
 	)
 {
-	std::fill ( std::begin ( voiceDC ), std::end ( voiceDC ), getVref () );
+	// The parameters of the tables not known to the base class
+	const double	params[] = { MIXER_N_RATIO, VOLUME_N_DIVISOR };
+	const auto		hash = TableCache::getHash ( resGain, sizeof ( resGain ), TableCache::getHash ( params, sizeof ( params ) ) );
+
+	tables_t*	tables;
+	if ( openTables ( tables, "8580", hash ) )
+		return;
+
+	buildOpampRevTable ( opamp_voltage_8580, OPAMP_SIZE_8580 );
 
 	// Create lookup tables for gains / summers.
 	auto clBuildSummerTable = [ this ]
@@ -143,12 +151,12 @@ FilterModelConfig8580::FilterModelConfig8580 () :
 	auto clBuildMixerTable = [ this ]
 	{
 		OpAmp opampModel ( std::vector<Spline::Point> ( std::begin ( opamp_voltage_8580 ), std::end ( opamp_voltage_8580 ) ), Vddt, vmin, vmax );
-		buildMixerTable ( opampModel, 8.0 / 5.0 );
+		buildMixerTable ( opampModel, MIXER_N_RATIO );
 	};
 	auto clBuildVolumeTable = [ this ]
 	{
 		OpAmp opampModel ( std::vector<Spline::Point> ( std::begin ( opamp_voltage_8580 ), std::end ( opamp_voltage_8580 ) ), Vddt, vmin, vmax );
-		buildVolumeTable ( opampModel, 16.0 );
+		buildVolumeTable ( opampModel, VOLUME_N_DIVISOR );
 	};
 	auto clBuildResonanceTable = [ this ]
 	{
@@ -156,10 +164,15 @@ FilterModelConfig8580::FilterModelConfig8580 () :
 		buildResonanceTable ( opampModel, resGain );
 	};
 
-	auto    thdSummer = std::jthread ( clBuildSummerTable );
-	auto    thdMixer = std::jthread ( clBuildMixerTable );
-	auto    thdVolume = std::jthread ( clBuildVolumeTable );
-	auto    thdResonance = std::jthread ( clBuildResonanceTable );
+	{
+		auto    thdSummer = std::jthread ( clBuildSummerTable );
+		auto    thdMixer = std::jthread ( clBuildMixerTable );
+		auto    thdVolume = std::jthread ( clBuildVolumeTable );
+		auto    thdResonance = std::jthread ( clBuildResonanceTable );
+	}
+
+	// Once all threads are done
+	storeTables ();
 }
 //-----------------------------------------------------------------------------
 
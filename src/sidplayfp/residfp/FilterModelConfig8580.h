@@ -49,7 +49,10 @@ private:
 public:
 	FilterModelConfig8580 ();
 
-	[[ nodiscard ]] static FilterModelConfig8580* getInstance ();
+	/**
+	* The tables are built once per process and shared read-only by all filters.
+	*/
+	[[ nodiscard ]] static const FilterModelConfig8580* getInstance ();
 
 public:
 	[[ nodiscard ]] sidinline constexpr double getVref () const { return Vref * VOLTAGE_SKEW; }
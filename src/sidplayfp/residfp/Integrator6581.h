@@ -177,8 +177,13 @@ private:
 
 	unsigned int	nVddt_Vw_2 = 0;
 
-	const uint16_t	nVddt;
-	const uint16_t	nVt;
+	// Set by the filter range
+	double		uCox;
+	uint16_t	nSnake;
+
+	// Set on construction, rounded so that every chip gets the same values
+	uint16_t	nVddt;
+	uint16_t	nVt;
 	const uint16_t	nVmin;
 
 	const FilterModelConfig6581& fmc;
@@ -186,11 +191,21 @@ private:
 public:
 	Integrator6581 ( const FilterModelConfig6581& _fmc )
 		: wlSnake ( _fmc.getWL_snake () )
-		, nVddt ( _fmc.getNormalizedValue ( _fmc.getVddt () ) )
-		, nVt ( _fmc.getNormalizedValue ( _fmc.getVth () ) )
+		, nVddt ( _fmc.getNormalizedValueRounded ( _fmc.getVddt () ) )
+		, nVt ( _fmc.getNormalizedValueRounded ( _fmc.getVth () ) )
 		, nVmin ( _fmc.getNVmin () )
 		, fmc ( _fmc )
 	{
+		setUCox ( fmc.getUCox () );
+	}
+
+	/**
+	* Set the transconductance coefficient u*Cox, which sets the filter range.
+	*/
+	void setUCox ( double _uCox )
+	{
+		uCox = _uCox;
+		nSnake = fmc.getNormalizedCurrentFactor<13> ( wlSnake, uCox );
 	}
 
 	sidinline void setVw ( uint16_t Vw )
@@ -198,6 +213,12 @@ public:
 		nVddt_Vw_2 = ( ( nVddt - Vw ) * ( nVddt - Vw ) ) >> 1;
 	}
 
+	/**
+	* Save or restore the capacitor state along with the bias voltages.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar ) { ar ( vx, vc, nVddt, nVt ); }
+
 	sidinline int solve ( int vi )
 	{
 		// Make sure Vgst>0 so we're not in subthreshold mode
@@ -215,7 +236,7 @@ public:
 		const unsigned int Vgdt_2 = Vgdt * Vgdt;
 
 		// "Snake" current, scaled by (1/m)*2^13*m*2^16*m*2^16*2^-15 = m*2^30
-		const auto	n_I_snake = fmc.getNormalizedCurrentFactor<13> ( wlSnake ) * ( int ( Vgst_2 - Vgdt_2 ) >> 15 );
+		const auto	n_I_snake = nSnake * ( int ( Vgst_2 - Vgdt_2 ) >> 15 );
 
 		// VCR gate voltage.       // Scaled by m*2^16
 		// Vg = Vddt - sqrt(((Vddt - Vw)^2 + Vgdt^2)/2)
@@ -235,8 +256,8 @@ public:
 		assert ( ( kVgt_Vd >= 0 ) && ( kVgt_Vd < ( 1 << 16 ) ) );
 
 		// VCR current, scaled by m*2^15*2^15 = m*2^30
-		const unsigned int If = static_cast<unsigned int>( fmc.getVcr_n_Ids_term ( kVgt_Vs ) ) << 15;
-		const unsigned int Ir = static_cast<unsigned int>( fmc.getVcr_n_Ids_term ( kVgt_Vd ) ) << 15;
+		const unsigned int If = static_cast<unsigned int>( fmc.getVcr_n_Ids_term ( kVgt_Vs, uCox ) ) << 15;
+		const unsigned int Ir = static_cast<unsigned int>( fmc.getVcr_n_Ids_term ( kVgt_Vd, uCox ) ) << 15;
 
 		#ifdef SLOPE_FACTOR
 			const double iVcr = static_cast<double>( If - Ir );
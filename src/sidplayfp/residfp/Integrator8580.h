@@ -87,9 +87,15 @@ public:
 
 		// Vg - Vth, normalized so that translated values can be subtracted:
 		// Vgt - x = (Vgt - t) - (x - t)
-		nVgt = fmc.getNormalizedValue ( Vgt );
+		nVgt = fmc.getNormalizedValueRounded ( Vgt );
 	}
 
+	/**
+	* Save or restore the capacitor state along with the gate voltage.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar ) { ar ( vx, vc, nVgt ); }
+
 	sidinline int solve ( int vi )
 	{
 		// Make sure we're not in subthreshold mode
@@ -22,6 +22,7 @@
 
 #include "SID.h"
 
+#include <cmath>
 #include <limits>
 
 #include "Dac.h"
@@ -127,8 +128,6 @@ constexpr auto	BUS_TTL_8580 = 0xA2000;
 
 SID::SID ()
 {
-	waveTable = WaveformCalculator::buildWaveTable ();
-
 	reset ();
 	setChipModel ( MOS8580 );
 }
@@ -159,7 +158,7 @@ void SID::setChipModel ( ChipModel _model )
 		vce.setEnvDAC ( envDAC );
 		vce.setWavDAC ( oscDAC );
 		vce.waveformGenerator.setModel ( model == MOS6581 );
-		vce.waveformGenerator.setWaveformModels ( waveTable );
+		vce.waveformGenerator.setWaveformModels ( WaveformCalculator::getWaveTable () );
 	}
 
 	setCombinedWaveforms ( CombinedWaveforms::STRONG, model == MOS6581 ? 1.0f : 1.0f );
@@ -229,6 +228,10 @@ void SID::reset ()
 	externalFilter.reset ();
 
 	resampler.reset ();
+	blockResampler.reset ();
+	zeroOrderResampler.reset ();
+
+	scope.reset ();
 
 	busValue = 0;
 	busValueTtl = 0;
@@ -313,11 +316,27 @@ void SID::write ( int offset, uint8_t value )
 }
 //-----------------------------------------------------------------------------
 
-void SID::setSamplingParameters ( double clockFrequency, double samplingFrequency )
+void SID::setSamplingParameters ( double clockFrequency, double samplingFrequency, SamplingMethod method )
 {
 	externalFilter.setClockFrequency ( clockFrequency );
 
-	resampler.setup ( clockFrequency, samplingFrequency );
+	samplingMethod = method;
+
+	switch ( method )
+	{
+		case RESAMPLE_BLOCK:	blockResampler.setup ( clockFrequency, samplingFrequency );			break;
+		case RESAMPLE_FAST:		blockResampler.setup ( clockFrequency, samplingFrequency, 8 );		break;
+		case DECIMATE:			zeroOrderResampler.setup ( clockFrequency, samplingFrequency );	break;
+		default:				resampler.setup ( clockFrequency, samplingFrequency );				break;
+	}
+}
+//-----------------------------------------------------------------------------
+
+void SID::setScope ( double clockFrequency, double scopeFrequency, unsigned int length )
+{
+	const auto	cyclesPerSample = scopeFrequency > 0.0 ? std::max ( 1.0, std::round ( clockFrequency / scopeFrequency ) ) : 0.0;
+
+	scope.setup ( (unsigned int)cyclesPerSample, length );
 }
 //-----------------------------------------------------------------------------
 
@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <algorithm>
+#include <type_traits>
 
 #include "../../EZ/config.h"
 
@@ -30,13 +31,17 @@ namespace reSIDfp
 {
 	typedef enum { MOS6581 = 1, MOS8580 } ChipModel;
 	typedef enum { WEAK, AVERAGE, STRONG } CombinedWaveforms;
+	typedef enum { RESAMPLE, RESAMPLE_BLOCK, RESAMPLE_FAST, DECIMATE } SamplingMethod;
 }
 
 #include "Filter6581.h"
 #include "Filter8580.h"
 #include "ExternalFilter.h"
 #include "Voice.h"
+#include "ScopeTap.h"
+#include "resample/BlockResampler.h"
 #include "resample/TwoPassSincResampler.h"
+#include "resample/ZeroOrderResampler.h"
 
 namespace reSIDfp
 {
@@ -61,13 +66,23 @@ private:
 	// External filter that provides high-pass and low-pass filtering to adjust sound tone slightly
 	ExternalFilter	externalFilter;
 
-	// Table of waveforms
-	std::vector<int16_t>	waveTable;
+	// Table of combined waveforms, the plain ones are shared
 	std::vector<int16_t>	pulldownTable;
 
 	// Resampler used by audio generation code
 	TwoPassSincResampler	resampler;
 
+	// Resampler used instead, if the sampling method is RESAMPLE_BLOCK or RESAMPLE_FAST
+	BlockResampler	blockResampler;
+
+	// Resampler used instead, if the sampling method is DECIMATE
+	ZeroOrderResampler	zeroOrderResampler;
+
+	SamplingMethod	samplingMethod = RESAMPLE;
+
+	// Oscilloscope capture, fed only by the tapped variant of #run
+	ScopeTap	scope;
+
 	static constexpr int	numVoices = 3;
 
 	// SID voices
@@ -145,6 +160,186 @@ private:
 
 	void recalculateDACs ();
 
+	/**
+	* Clock SID forward, feeding the resampler if audible.
+	*
+	* @tparam method the sampling method in use
+	* @tparam sample_t int16_t for soft clipped samples, float for unclipped ones
+	* @tparam tapped feed the outputs of each cycle to the scope too
+	* @param cycles c64 clocks to clock
+	* @param buf audio output buffer
+	* @return number of samples produced, or skipped if not audible
+	*/
+	template<bool audible, SamplingMethod method, typename sample_t = int16_t, bool tapped = false>
+	sidinline int run ( unsigned int cycles, sample_t* buf )
+	{
+		// ageBusValue
+		if ( busValueTtl )
+		{
+			if ( busValueTtl -= cycles; busValueTtl <= 0 )
+			{
+				busValue = 0;
+				busValueTtl = 0;
+			}
+		}
+
+		auto output = [ this ] () -> int
+		{
+			const auto	o1 = voice[ 0 ].output ( voice[ 2 ].waveformGenerator );
+			const auto	o2 = voice[ 1 ].output ( voice[ 0 ].waveformGenerator );
+			const auto	o3 = voice[ 2 ].output ( voice[ 1 ].waveformGenerator );
+
+			auto filterOutput = [ & ] () -> int
+			{
+				if ( model == MOS8580 )
+					return filter8580.clock ( o1, o2, o3 );
+
+				const auto	env1 = voice[ 0 ].envelopeGenerator.output ();
+				const auto	env2 = voice[ 1 ].envelopeGenerator.output ();
+				const auto	env3 = voice[ 2 ].envelopeGenerator.output ();
+
+				return filter6581.clock ( o1, o2, o3, env1, env2, env3 );
+			};
+
+			const auto	input = filterOutput ();
+
+			if constexpr ( tapped )
+				scope.input ( o1, o2, o3, input );
+
+			return externalFilter.clock ( input );
+		};
+
+		constexpr auto	block = method == RESAMPLE_BLOCK || method == RESAMPLE_FAST;
+
+		auto    s = 0;
+
+		if constexpr ( ! audible )
+		{
+			if constexpr ( block )
+				s = int ( blockResampler.skip ( cycles ) );
+			else if constexpr ( method == DECIMATE )
+				s = int ( zeroOrderResampler.skip ( cycles ) );
+			else
+				s = int ( resampler.skip ( cycles ) );
+		}
+
+		// Cycle samples collected for the block resampler
+		int32_t*	blockInput = nullptr;
+		auto		blockCount = 0;
+
+		if constexpr ( audible && block )
+			blockInput = blockResampler.input ();
+
+		while ( cycles )
+		{
+			if ( auto delta_t = std::min ( nextVoiceSync, cycles ); delta_t > 0 )
+			{
+				auto	i = 0u;
+
+				if constexpr ( ! audible )
+				{
+					// Jump ahead if the outputs don't affect the state,
+					// only the last two cycles are needed to bring them up to date
+					if ( delta_t > 2
+						&& voice[ 0 ].waveformGenerator.canFastForward ()
+						&& voice[ 1 ].waveformGenerator.canFastForward ()
+						&& voice[ 2 ].waveformGenerator.canFastForward () )
+					{
+						i = delta_t - 2;
+
+						for ( auto& vce : voice )
+						{
+							vce.waveformGenerator.fastForward ( i );
+							vce.envelopeGenerator.fastForward ( i );
+						}
+					}
+				}
+
+				for ( ; i < delta_t; i++ )
+				{
+					// clock waveform generators
+					voice[ 0 ].waveformGenerator.clock ();
+					voice[ 1 ].waveformGenerator.clock ();
+					voice[ 2 ].waveformGenerator.clock ();
+
+					// clock envelope generators
+					voice[ 0 ].envelopeGenerator.clock ();
+					voice[ 1 ].envelopeGenerator.clock ();
+					voice[ 2 ].envelopeGenerator.clock ();
+
+					if constexpr ( audible && block )
+					{
+						blockInput[ blockCount++ ] = output ();
+
+						if ( blockCount == BlockResampler::BLOCKSIZE )
+						{
+							s += blockResampler.process ( blockCount, buf + s, scaleFactor );
+							blockCount = 0;
+						}
+					}
+					else if constexpr ( audible && method == DECIMATE )
+					{
+						if ( zeroOrderResampler.input ( output () ) )
+						{
+							if constexpr ( std::is_same_v<sample_t, float> )
+								buf[ s++ ] = zeroOrderResampler.outputFloat ( scaleFactor );
+							else
+								buf[ s++ ] = zeroOrderResampler.output ( scaleFactor );
+						}
+					}
+					else if constexpr ( audible )
+					{
+						if ( resampler.input ( output () ) )
+						{
+							if constexpr ( std::is_same_v<sample_t, float> )
+								buf[ s++ ] = resampler.outputFloat ( scaleFactor );
+							else
+								buf[ s++ ] = resampler.output ( scaleFactor );
+						}
+					}
+					else
+					{
+						// Keep the oscillator outputs, OSC3 and the noise write-back up to date
+						voice[ 0 ].waveformGenerator.output ( voice[ 2 ].waveformGenerator );
+						voice[ 1 ].waveformGenerator.output ( voice[ 0 ].waveformGenerator );
+						voice[ 2 ].waveformGenerator.output ( voice[ 1 ].waveformGenerator );
+					}
+				}
+
+				cycles -= delta_t;
+				nextVoiceSync -= delta_t;
+			}
+
+			if ( ! nextVoiceSync )
+				voiceSync ( true );
+		}
+
+		if constexpr ( audible && block )
+		{
+			if ( blockCount )
+				s += blockResampler.process ( blockCount, buf + s, scaleFactor );
+		}
+
+		return s;
+	}
+
+	/**
+	* Clock SID forward with the chosen sampling method.
+	*
+	* @tparam tapped feed the scope too
+	*/
+	template<bool tapped, typename sample_t>
+	sidinline int generate ( unsigned int cycles, sample_t* buf )
+	{
+		switch ( samplingMethod )
+		{
+			case RESAMPLE_BLOCK:	return run<true, RESAMPLE_BLOCK, sample_t, tapped> ( cycles, buf );
+			case RESAMPLE_FAST:		return run<true, RESAMPLE_FAST, sample_t, tapped> ( cycles, buf );
+			case DECIMATE:			return run<true, DECIMATE, sample_t, tapped> ( cycles, buf );
+			default:				return run<true, RESAMPLE, sample_t, tapped> ( cycles, buf );
+		}
+	}
+
 public:
 	SID ();
 
@@ -181,6 +376,31 @@ public:
 	*/
 	void reset ();
 
+	/**
+	* Save or restore the chip state.
+	* The chip model and sampling parameters must be the same.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( busValue, busValueTtl, nextVoiceSync );
+
+		for ( auto& vce : voice )
+			vce.serialize ( ar );
+
+		filter6581.serialize ( ar );
+		filter8580.serialize ( ar );
+		externalFilter.serialize ( ar );
+
+		switch ( samplingMethod )
+		{
+			case RESAMPLE_BLOCK:
+			case RESAMPLE_FAST:	blockResampler.serialize ( ar );		break;
+			case DECIMATE:		zeroOrderResampler.serialize ( ar );	break;
+			default:			resampler.serialize ( ar );				break;
+		}
+	}
+
 	/**
 	* Read registers
 	*
@@ -230,84 +450,66 @@ public:
 	* is limited to slightly below 20kHz.
 	* This constraint ensures that the FIR table is not overfilled.
 	*
+	* RESAMPLE_BLOCK gives the same stopband attenuation as RESAMPLE,
+	* with less work per cycle, but not the same samples.
+	* RESAMPLE_FAST is the same with short filters for -48dB.
+	* DECIMATE interpolates between the cycles without any filtering.
+	*
 	* @param clockFrequency System clock frequency at Hz
 	* @param samplingFrequency Desired output sampling rate
-	* @param highestAccurateFrequency
+	* @param method resampler to use
 	* @throw SIDError
 	*/
-	void setSamplingParameters ( double clockFrequency, double samplingFrequency );
+	void setSamplingParameters ( double clockFrequency, double samplingFrequency, SamplingMethod method = RESAMPLE );
 
 	/**
 	* Clock SID forward using chosen output sampling algorithm.
 	*
+	* The samples are either int16_t, soft clipped,
+	* or float without clipping, with the full scale of int16_t at 1.0.
+	* The scope is fed along, if enabled.
+	*
 	* @param cycles c64 clocks to clock
 	* @param buf audio output buffer
 	* @return number of samples produced
 	*/
-	sidinline int clock ( unsigned int cycles, int16_t* buf )
+	template<typename sample_t>
+	sidinline int clock ( unsigned int cycles, sample_t* buf )
 	{
-		// ageBusValue
-		if ( busValueTtl )
-		{
-			if ( busValueTtl -= cycles; busValueTtl <= 0 )
-			{
-				busValue = 0;
-				busValueTtl = 0;
-			}
-		}
-
-		auto output = [ this ] () -> int
-		{
-			const auto	o1 = voice[ 0 ].output ( voice[ 2 ].waveformGenerator );
-			const auto	o2 = voice[ 1 ].output ( voice[ 0 ].waveformGenerator );
-			const auto	o3 = voice[ 2 ].output ( voice[ 1 ].waveformGenerator );
-
-			if ( model == MOS8580 )
-			{
-				const auto	input = int ( filter8580.clock ( o1, o2, o3 ) );
-				return externalFilter.clock ( input );
-			}
+		// A variant of its own, so the cycles don't pay for the scope while it is off
+		if ( scope.isEnabled () )
+			return generate<true> ( cycles, buf );
 
-			const auto	env1 = voice[ 0 ].envelopeGenerator.output ();
-			const auto	env2 = voice[ 1 ].envelopeGenerator.output ();
-			const auto	env3 = voice[ 2 ].envelopeGenerator.output ();
-
-			const auto	input = int ( filter6581.clock ( o1, o2, o3, env1, env2, env3 ) );
-			return externalFilter.clock ( input );
-		};
+		return generate<false> ( cycles, buf );
+	}
 
-		auto    s = 0;
-		while ( cycles )
+	/**
+	* Clock SID forward without producing any output.
+	* Only the oscillators, envelopes and the output phase of the resampler advance,
+	* the filters keep their state and the scope is left alone.
+	*
+	* @param cycles c64 clocks to clock
+	* @return number of samples skipped, as many as clocking the same cycles audibly would produce
+	*/
+	sidinline int fastForward ( unsigned int cycles )
+	{
+		// The block resamplers only differ in their filters
+		switch ( samplingMethod )
 		{
-			if ( auto delta_t = std::min ( nextVoiceSync, cycles ); delta_t > 0 )
-			{
-				for ( auto i = 0u; i < delta_t; i++ )
-				{
-					// clock waveform generators
-					voice[ 0 ].waveformGenerator.clock ();
-					voice[ 1 ].waveformGenerator.clock ();
-					voice[ 2 ].waveformGenerator.clock ();
-
-					// clock envelope generators
-					voice[ 0 ].envelopeGenerator.clock ();
-					voice[ 1 ].envelopeGenerator.clock ();
-					voice[ 2 ].envelopeGenerator.clock ();
-
-					if ( resampler.input ( output () ) )
-						buf[ s++ ] = int16_t ( resampler.output ( scaleFactor ) );
-				}
-
-				cycles -= delta_t;
-				nextVoiceSync -= delta_t;
-			}
-
-			if ( ! nextVoiceSync )
-				voiceSync ( true );
+			case RESAMPLE_BLOCK:
+			case RESAMPLE_FAST:		return run<false, RESAMPLE_BLOCK, int16_t> ( cycles, nullptr );
+			case DECIMATE:			return run<false, DECIMATE, int16_t> ( cycles, nullptr );
+			default:				return run<false, RESAMPLE, int16_t> ( cycles, nullptr );
 		}
-
-		return s;
 	}
 
+	/**
+	* Settle the external filter faster, after fast forwarding.
+	*
+	* @param enable true to speed up, false for normal operation
+	*/
+	void settle ( bool enable )	{	externalFilter.settle ( enable );	}
+
 	/**
 	* Set filter curve parameter for 6581 model.
 	*
@@ -344,6 +546,32 @@ public:
 	void setFilter8580Curve ( double filterCurve )	{	filter8580.setFilterCurve ( filterCurve );	}
 
 	float getEnvLevel ( int voiceNo ) const		{	return voice[ voiceNo ].getEnvLevel (); }
+
+	/**
+	* Voice 3 oscillator and envelope outputs as read from $1b and $1c, without driving the bus.
+	*/
+	uint8_t getOsc3 () const	{	return voice[ 2 ].waveformGenerator.readOSC ();		}
+	uint8_t getEnv3 () const	{	return voice[ 2 ].envelopeGenerator.readENV ();		}
+
+	/**
+	* Capture the outputs of the voices and the filter for oscilloscopes while clocking,
+	* each averaged over the cycles of a sample. Drops what was captured so far.
+	*
+	* @param clockFrequency System clock frequency at Hz
+	* @param scopeFrequency Sampling rate of the capture, 0 disables it
+	* @param length samples kept per channel, rounded up to a power of two
+	*/
+	void setScope ( double clockFrequency, double scopeFrequency, unsigned int length );
+
+	/**
+	* @see ScopeTap::read
+	*/
+	uint32_t readScope ( int channel, float* buffer, uint32_t samples ) const	{	return scope.read ( channel, buffer, samples );	}
+
+	/**
+	* @see ScopeTap::getPosition
+	*/
+	uint32_t getScopePosition () const	{	return scope.getPosition ();	}
 };
 //-----------------------------------------------------------------------------
 
@@ -0,0 +1,177 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdint.h>
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include "../../EZ/config.h"
+
+namespace reSIDfp
+{
+
+/**
+* Oscilloscope capture of the voices and the filter output.
+*
+* Each cycle's outputs are summed over a fixed number of cycles and the
+* average of each box goes into a ring per channel, scaled to -1 .. 1.
+* The voices are taken after the envelope, the filter output before the
+* external filter, so the DC offsets of the chip are left in.
+*/
+class ScopeTap final
+{
+public:
+	// The three voices followed by the filter output
+	static constexpr int	CHANNELS = 4;
+
+private:
+	// The voices swing about -0.5 .. 0.5 with the normalised DACs, the filter output is biased by 0x8000
+	static constexpr float	VOICE_SCALE = 2.0f;
+	static constexpr float	FILTER_SCALE = 1.0f / 32768.0f;
+
+	// The rings of the channels one after the other
+	std::vector<float>	rings;
+
+	uint32_t	mask = 0;
+
+	// Free running position of the next sample to write, wrapped on access
+	uint32_t	writePos = 0;
+
+	// Samples in the ring, up to its size
+	uint32_t	filled = 0;
+
+	// Cycles per sample, 0 when disabled
+	unsigned int	factor = 0;
+	unsigned int	count = 0;
+
+	float	sums[ CHANNELS ] = {};
+	float	scales[ CHANNELS ] = {};
+
+public:
+	/**
+	* Set up the capture, dropping what was captured so far.
+	*
+	* @param cyclesPerSample the cycles averaged into each sample, 0 disables the capture
+	* @param length samples kept per channel, rounded up to a power of two
+	*/
+	void setup ( unsigned int cyclesPerSample, unsigned int length )
+	{
+		factor = length ? cyclesPerSample : 0;
+
+		if ( factor )
+		{
+			const auto	size = std::bit_ceil ( length );
+
+			rings.assign ( size_t ( size ) * CHANNELS, 0.0f );
+			mask = size - 1;
+
+			const auto	box = 1.0f / float ( factor );
+
+			std::fill_n ( scales, CHANNELS - 1, VOICE_SCALE * box );
+			scales[ CHANNELS - 1 ] = FILTER_SCALE * box;
+		}
+		else
+		{
+			rings = {};
+			mask = 0;
+		}
+
+		reset ();
+	}
+
+	/**
+	* Drop what was captured so far.
+	*/
+	void reset ()
+	{
+		std::fill ( rings.begin (), rings.end (), 0.0f );
+		std::fill_n ( sums, CHANNELS, 0.0f );
+
+		writePos = 0;
+		filled = 0;
+		count = 0;
+	}
+
+	[[ nodiscard ]] sidinline bool isEnabled () const { return factor != 0; }
+
+	/**
+	* Add the outputs of a cycle.
+	*
+	* @param voice1 output of voice 1, as passed to the filter
+	* @param voice2 output of voice 2
+	* @param voice3 output of voice 3
+	* @param filter output of the filter, as passed to the external filter
+	*/
+	sidinline void input ( float voice1, float voice2, float voice3, int filter )
+	{
+		sums[ 0 ] += voice1;
+		sums[ 1 ] += voice2;
+		sums[ 2 ] += voice3;
+		sums[ 3 ] += float ( filter - 0x8000 );
+
+		if ( ++count < factor )
+			return;
+
+		const auto	size = mask + 1;
+		auto		pos = writePos++ & mask;
+
+		for ( auto c = 0; c < CHANNELS; c++, pos += size )
+		{
+			rings[ pos ] = sums[ c ] * scales[ c ];
+			sums[ c ] = 0.0f;
+		}
+
+		filled += filled <= mask;
+		count = 0;
+	}
+
+	/**
+	* Get the number of samples captured per channel since the last setup or reset, wrapping around.
+	* The difference between two calls tells how many samples are new.
+	*/
+	[[ nodiscard ]] uint32_t getPosition () const { return writePos; }
+
+	/**
+	* Copy out the latest samples of a channel, the oldest first.
+	*
+	* @param channel 0 .. 2 for the voices, 3 for the filter output
+	* @param buffer output
+	* @param samples number of samples wanted
+	* @return number of samples copied, at most the length of the ring and the samples captured
+	*/
+	uint32_t read ( int channel, float* buffer, uint32_t samples ) const
+	{
+		if ( ! factor || channel < 0 || channel >= CHANNELS )
+			return 0;
+
+		const auto	size = mask + 1;
+		const auto	available = std::min ( samples, filled );
+		const auto	start = ( writePos - available ) & mask;
+		const auto	first = std::min ( available, size - start );
+		const auto	ring = rings.data () + size_t ( channel ) * size;
+
+		std::copy_n ( ring + start, first, buffer );
+		std::copy_n ( ring, available - first, buffer + first );
+
+		return available;
+	}
+};
+
+} // namespace reSIDfp
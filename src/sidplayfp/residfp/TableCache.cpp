@@ -0,0 +1,229 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "TableCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace reSIDfp
+{
+
+constexpr char	MAGIC[ 8 ] = { 'r', 'e', 'S', 'I', 'D', 'f', 'p', 'T' };
+
+static std::mutex	directoryLock;
+static std::string	cacheDirectory;
+
+//-----------------------------------------------------------------------------
+
+void TableCache::setDirectory ( const std::string& directory )
+{
+	std::lock_guard	guard ( directoryLock );
+	cacheDirectory = directory;
+}
+//-----------------------------------------------------------------------------
+
+std::string TableCache::getDirectory ()
+{
+	std::lock_guard	guard ( directoryLock );
+	return cacheDirectory;
+}
+//-----------------------------------------------------------------------------
+
+uint64_t TableCache::getHash ( const void* data, size_t size, uint64_t h )
+{
+	auto	p = static_cast<const uint8_t*> ( data );
+
+	for ( auto i = size_t ( 0 ); i < size; i++ )
+		h = ( h ^ p[ i ] ) * 1099511628211ull;
+
+	return h;
+}
+//-----------------------------------------------------------------------------
+
+TableCache::~TableCache ()
+{
+	unmap ();
+}
+//-----------------------------------------------------------------------------
+
+bool TableCache::open ( const char* name, uint64_t _hash, size_t _size )
+{
+	hash = _hash;
+	size = _size;
+
+	#ifdef RESIDFP_EMBEDDED_TABLES
+		for ( auto e = embedded; e->name; e++ )
+		{
+			if ( std::strcmp ( e->name, name ) == 0 && e->format == FORMAT && e->hash == hash && e->size == size )
+			{
+				builtIn = e->data;
+				return true;
+			}
+		}
+	#endif
+
+	if ( const auto directory = getDirectory (); ! directory.empty () )
+	{
+		filename = ( std::filesystem::path ( directory ) / ( std::string ( "reSIDfp-" ) + name + ".tables" ) ).string ();
+
+		if ( map () )
+			return true;
+	}
+
+	buffer.reset ( new uint8_t[ size ] );
+	return false;
+}
+//-----------------------------------------------------------------------------
+
+bool TableCache::map ()
+{
+	const auto	fileSize = HEADER_SIZE + size;
+
+	#ifdef _WIN32
+		const auto	file = CreateFileW ( std::filesystem::path ( filename ).c_str (), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+		if ( file == INVALID_HANDLE_VALUE )
+			return false;
+
+		LARGE_INTEGER	actualSize;
+		if ( ! GetFileSizeEx ( file, &actualSize ) || uint64_t ( actualSize.QuadPart ) != fileSize )
+		{
+			CloseHandle ( file );
+			return false;
+		}
+
+		// The view keeps the file mapped, the handles aren't needed anymore
+		const auto	fileMapping = CreateFileMappingW ( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+		CloseHandle ( file );
+
+		if ( ! fileMapping )
+			return false;
+
+		mapping = MapViewOfFile ( fileMapping, FILE_MAP_READ, 0, 0, 0 );
+		CloseHandle ( fileMapping );
+
+		if ( ! mapping )
+			return false;
+	#else
+		const auto	fd = ::open ( filename.c_str (), O_RDONLY );
+		if ( fd < 0 )
+			return false;
+
+		struct stat	st;
+		if ( fstat ( fd, &st ) != 0 || uint64_t ( st.st_size ) != fileSize )
+		{
+			close ( fd );
+			return false;
+		}
+
+		// The mapping keeps the file open
+		const auto	p = mmap ( nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0 );
+		close ( fd );
+
+		if ( p == MAP_FAILED )
+			return false;
+
+		mapping = p;
+	#endif
+
+	mappingSize = fileSize;
+
+	header_t	header;
+	std::memcpy ( &header, mapping, sizeof ( header ) );
+
+	if ( std::memcmp ( header.magic, MAGIC, sizeof ( MAGIC ) ) != 0 || header.format != FORMAT || header.hash != hash || header.size != size )
+	{
+		unmap ();
+		return false;
+	}
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+void TableCache::unmap ()
+{
+	if ( ! mapping )
+		return;
+
+	#ifdef _WIN32
+		UnmapViewOfFile ( mapping );
+	#else
+		munmap ( mapping, mappingSize );
+	#endif
+
+	mapping = nullptr;
+	mappingSize = 0;
+}
+//-----------------------------------------------------------------------------
+
+void TableCache::store () const
+{
+	if ( builtIn || mapping || ! buffer || filename.empty () )
+		return;
+
+	std::error_code	ec;
+	std::filesystem::create_directories ( std::filesystem::path ( filename ).parent_path (), ec );
+
+	// Written aside and renamed, so that other processes never map a partial file
+	const auto	tmpname = filename + "." + std::to_string ( std::random_device () () ) + ".tmp";
+	{
+		std::ofstream	out ( tmpname, std::ios::out | std::ios::binary | std::ios::trunc );
+
+		header_t	header = {};
+		std::memcpy ( header.magic, MAGIC, sizeof ( MAGIC ) );
+		header.format = FORMAT;
+		header.hash = hash;
+		header.size = size;
+
+		char	padded[ HEADER_SIZE ] = {};
+		std::memcpy ( padded, &header, sizeof ( header ) );
+
+		out.write ( padded, HEADER_SIZE );
+		out.write ( reinterpret_cast<const char*> ( buffer.get () ), std::streamsize ( size ) );
+
+		if ( ! out )
+		{
+			out.close ();
+			std::filesystem::remove ( tmpname, ec );
+			return;
+		}
+	}
+
+	std::filesystem::rename ( tmpname, filename, ec );
+	if ( ec )
+		std::filesystem::remove ( tmpname, ec );
+}
+//-----------------------------------------------------------------------------
+
+} // namespace reSIDfp
@@ -0,0 +1,134 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+namespace reSIDfp
+{
+
+/**
+* Memory for the lookup tables of a filter model, mapped read-only from a cache file
+* if one was written before with the same hash, else allocated to build the tables in.
+*
+* The cache is off unless a directory is set. A file whose hash doesn't match,
+* written by another version or for other model constants, is rebuilt and replaced.
+*
+* Built with RESIDFP_EMBEDDED_TABLES defined, the tables generated by tools/gentables.cpp
+* are linked into the library and used before all else, as long as their hash matches.
+* After changing the model constants the tables are built at runtime again,
+* until they are generated anew.
+*/
+class TableCache final
+{
+public:
+	struct embedded_t
+	{
+		const char*	name;
+		uint64_t	format;
+		uint64_t	hash;
+		size_t		size;
+		const void*	data;
+	};
+
+private:
+	// Bumped whenever the way the tables are built changes
+	static constexpr uint64_t	FORMAT = 1;
+
+	// The file starts with the header, the tables follow at this offset.
+	// Read by tools/gentables.cpp as well
+	static constexpr size_t	HEADER_SIZE = 64;
+
+	struct header_t
+	{
+		char		magic[ 8 ];
+		uint64_t	format;
+		uint64_t	hash;
+		uint64_t	size;
+	};
+
+	static_assert ( sizeof ( header_t ) <= HEADER_SIZE );
+
+	// Generated, ends with an entry without a name
+	static const embedded_t	embedded[];
+
+	const void*	builtIn = nullptr;			// Tables linked into the library
+
+	std::unique_ptr<uint8_t[]>	buffer;		// Tables being built
+
+	void*	mapping = nullptr;				// Whole file, when mapped
+	size_t	mappingSize = 0;
+
+	std::string	filename;
+	uint64_t	hash = 0;
+	size_t		size = 0;
+
+	[[ nodiscard ]] static std::string getDirectory ();
+
+	[[ nodiscard ]] bool map ();
+	void unmap ();
+
+public:
+	TableCache () = default;
+	~TableCache ();
+
+	TableCache ( const TableCache& ) = delete;
+	TableCache& operator= ( const TableCache& ) = delete;
+
+	/**
+	* Set the directory of the cache files, empty to turn the cache off.
+	* Only affects the models which haven't been set up yet, so set it before creating the first SID.
+	*/
+	static void setDirectory ( const std::string& directory );
+
+	/**
+	* FNV-1a hash, chained through the last parameter.
+	*/
+	[[ nodiscard ]] static uint64_t getHash ( const void* data, size_t size, uint64_t h = 14695981039346656037ull );
+
+	/**
+	* Get the memory for the tables.
+	*
+	* @param name model name, part of the file name
+	* @param hash hash of everything the tables depend on
+	* @param size size of the tables in bytes
+	* @return true if linked in or mapped from the cache file, false if the tables must be built
+	*/
+	bool open ( const char* name, uint64_t hash, size_t size );
+
+	/**
+	* The tables, read-only unless being built.
+	*/
+	[[ nodiscard ]] void* data () const
+	{
+		if ( builtIn )
+			return const_cast<void*> ( builtIn );
+
+		return mapping ? static_cast<uint8_t*> ( mapping ) + HEADER_SIZE : buffer.get ();
+	}
+
+	/**
+	* Write the tables once built, for the next start. Failures are ignored,
+	* the cache is only an optimization.
+	*/
+	void store () const;
+};
+
+} // namespace reSIDfp
@@ -111,6 +111,18 @@ public:
 		envelopeGenerator.reset ();
 	}
 
+	/**
+	* Save or restore the voice state.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		waveformGenerator.serialize ( ar );
+		envelopeGenerator.serialize ( ar );
+
+		ar ( envLevel );
+	}
+
 	float getEnvLevel () const { return envLevel; }
 };
 
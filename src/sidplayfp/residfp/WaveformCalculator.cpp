@@ -21,6 +21,7 @@
 
 #include "WaveformCalculator.h"
 
+#include <array>
 #include <cmath>
 #include <map>
 #include <cassert>
@@ -160,9 +161,9 @@ const CombinedWaveformConfig	config[ 3 ][ 2 ][ 5 ] =
 };
 //-----------------------------------------------------------------------------
 
-std::vector<int16_t> WaveformCalculator::buildWaveTable ()
+static constexpr std::array<int16_t, 4 * 4096> buildWaveTable ()
 {
-	std::vector<int16_t>	waveTable ( 4 * 4096 );
+	std::array<int16_t, 4 * 4096>	waveTable = {};
 
 	// Calculate triangle waveform
 	auto triXor = [] ( int val )
@@ -184,6 +185,14 @@ std::vector<int16_t> WaveformCalculator::buildWaveTable ()
 
 	return waveTable;
 }
+
+// In the read-only data of the library
+static constexpr auto	waveTable = buildWaveTable ();
+
+const int16_t* WaveformCalculator::getWaveTable ()
+{
+	return waveTable.data ();
+}
 //-----------------------------------------------------------------------------
 
 /**
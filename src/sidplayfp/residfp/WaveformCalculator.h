@@ -20,6 +20,7 @@
 * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <stdint.h>
 #include <vector>
 
 namespace reSIDfp
@@ -80,11 +81,12 @@ namespace reSIDfp
 namespace WaveformCalculator
 {
 	/**
-	* Get the waveform table for use by WaveformGenerator
+	* Get the waveform table for use by WaveformGenerator,
+	* built at compile time and shared by all chips
 	*
-	* @return Waveform table
+	* @return Waveform table, 4 * 4096 entries
 	*/
-	std::vector<int16_t> buildWaveTable ();
+	[[ nodiscard ]] const int16_t* getWaveTable ();
 
 	/**
 	* Build pulldown table for use by WaveformGenerator
@@ -22,6 +22,8 @@
 
 #include "WaveformGenerator.h"
 
+#include <algorithm>
+
 namespace reSIDfp
 {
 
@@ -301,9 +303,9 @@ void WaveformGenerator::set_noise_output ()
 }
 //-----------------------------------------------------------------------------
 
-void WaveformGenerator::setWaveformModels ( std::vector<int16_t>& models )
+void WaveformGenerator::setWaveformModels ( const int16_t* models )
 {
-	model_wave = &models;
+	model_wave = models;
 }
 //-----------------------------------------------------------------------------
 
@@ -329,6 +331,27 @@ void WaveformGenerator::set_no_noise_or_noise_output ()
 }
 //-----------------------------------------------------------------------------
 
+void WaveformGenerator::set_waveform_tables ()
+{
+	auto	modWave = model_wave;
+	auto	modPulldown = model_pulldown->data ();
+
+	// Set up waveform tables
+	wave = &modWave[ ( waveform & 0x3 ) << 12 ];
+
+	// We assume the combinations including noise behave the same as without
+	switch ( waveform & 0x7 )
+	{
+		case 3:     pulldown = &modPulldown[ 0 << 12 ];									break;
+		case 4:     pulldown = ( waveform & 0x8 ) ? &modPulldown[ 4 << 12 ] : nullptr;	break;
+		case 5:     pulldown = &modPulldown[ 1 << 12 ];									break;
+		case 6:     pulldown = &modPulldown[ 2 << 12 ];									break;
+		case 7:     pulldown = &modPulldown[ 3 << 12 ];									break;
+		default:    pulldown = nullptr;													break;
+	}
+}
+//-----------------------------------------------------------------------------
+
 void WaveformGenerator::writeCONTROL_REG ( uint8_t control )
 {
 	const auto	waveform_prev = waveform;
@@ -343,22 +366,7 @@ void WaveformGenerator::writeCONTROL_REG ( uint8_t control )
 
 	if ( waveform != waveform_prev )
 	{
-		auto	modWave = model_wave->data ();
-		auto	modPulldown = model_pulldown->data ();
-
-		// Set up waveform tables
-		wave = &modWave[ ( waveform & 0x3 ) << 12 ];
-
-		// We assume the combinations including noise behave the same as without
-		switch ( waveform & 0x7 )
-		{
-			case 3:     pulldown = &modPulldown[ 0 << 12 ];									break;
-			case 4:     pulldown = ( waveform & 0x8 ) ? &modPulldown[ 4 << 12 ] : nullptr;	break;
-			case 5:     pulldown = &modPulldown[ 1 << 12 ];									break;
-			case 6:     pulldown = &modPulldown[ 2 << 12 ];									break;
-			case 7:     pulldown = &modPulldown[ 3 << 12 ];									break;
-			default:    pulldown = nullptr;													break;
-		}
+		set_waveform_tables ();
 
 		// no_noise and no_pulse are used in set_waveform_output() as bitmasks to
 		// only let the noise or pulse influence the output when the noise or pulse
@@ -398,6 +406,65 @@ void WaveformGenerator::writeCONTROL_REG ( uint8_t control )
 }
 //-----------------------------------------------------------------------------
 
+void WaveformGenerator::fastForward ( unsigned int cycles )
+{
+	// Age floating DAC input as the skipped outputs would
+	if ( waveform == 0 )
+	{
+		auto	outputs = cycles;
+
+		while ( floating_output_ttl && floating_output_ttl <= outputs )
+		{
+			outputs -= floating_output_ttl;
+			floating_output_ttl = 0;
+			fadeFloatingOutput ();
+		}
+
+		if ( floating_output_ttl )
+			floating_output_ttl -= outputs;
+	}
+
+	while ( cycles )
+	{
+		if ( test )
+		{
+			// The accumulator is held, only the shift register reset counts down
+			if ( const auto	steps = shift_register_reset ? std::min ( cycles, shift_register_reset - 1 ) : cycles; steps > 0 )
+			{
+				if ( shift_register_reset )
+					shift_register_reset -= steps;
+
+				test_or_reset = true;
+				pulse_output = 0xfff;
+
+				cycles -= steps;
+				continue;
+			}
+		}
+		else if ( shift_pipeline == 0 )
+		{
+			// Jump to the cycle before bit 19 of the accumulator is set high
+			const auto	phase = accumulator & 0xfffff;
+			const auto	edge = freq ? ( ( phase < 0x80000 ? 0x80000 : 0x180000 ) - phase + freq - 1 ) / freq : cycles + 1;
+
+			if ( const auto	steps = std::min ( cycles, edge - 1 ); steps > 0 )
+			{
+				const auto	accumulator_old = ( accumulator + ( steps - 1 ) * freq ) & 0xffffff;
+				accumulator = ( accumulator_old + freq ) & 0xffffff;
+				msb_rising = ( ~accumulator_old & accumulator ) & 0x800000;
+
+				cycles -= steps;
+				continue;
+			}
+		}
+
+		// Let the noise register shift
+		clock ();
+		cycles--;
+	}
+}
+//-----------------------------------------------------------------------------
+
 void WaveformGenerator::shiftregBitfade ()
 {
 	shift_register |= shift_register >> 1;
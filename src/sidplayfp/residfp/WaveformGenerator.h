@@ -83,10 +83,10 @@ namespace reSIDfp
 class WaveformGenerator final
 {
 private:
-	std::vector<int16_t>*	model_wave = nullptr;
+	const int16_t*			model_wave = nullptr;
 	std::vector<int16_t>*	model_pulldown = nullptr;
 
-	int16_t*	wave = nullptr;
+	const int16_t*	wave = nullptr;
 	int16_t*	pulldown = nullptr;
 
 	// PWout = (PWn/40.95)%
@@ -155,8 +155,21 @@ private:
 
 	void shiftregBitfade ();
 
+	void set_waveform_tables ();
+
+	sidinline void fadeFloatingOutput ()
+	{
+		constexpr auto	FLOATING_OUTPUT_FADE_6581R3 = 1400u;
+		constexpr auto	FLOATING_OUTPUT_FADE_8580R5 = 50000u;
+
+		waveform_output &= waveform_output >> 1;
+		osc3 = waveform_output;
+		if ( waveform_output )
+			floating_output_ttl = is6581 ? FLOATING_OUTPUT_FADE_6581R3 : FLOATING_OUTPUT_FADE_8580R5;
+	}
+
 public:
-	void setWaveformModels ( std::vector<int16_t>& models );
+	void setWaveformModels ( const int16_t* models );
 	void setPulldownModels ( std::vector<int16_t>& models );
 
 	/**
@@ -226,6 +239,25 @@ public:
 		}
 	}
 
+	/**
+	* Check whether the oscillator can be fast forwarded, which is the case
+	* if the output doesn't feed back into the accumulator or the noise shift register.
+	*/
+	[[ nodiscard ]] sidinline bool canFastForward () const
+	{
+		return waveform <= 0x8 && ! ( is6581 && ( waveform & 0x2 ) && waveform != 0x2 );
+	}
+
+	/**
+	* Advance the oscillator as if clocked and its output computed for a number of cycles,
+	* jumping directly between the shifts of the noise register.
+	* The output itself is left behind, so the last two cycles before it is used
+	* must be clocked normally.
+	*
+	* @param cycles number of cycles
+	*/
+	void fastForward ( unsigned int cycles );
+
 	/**
 	* Synchronize oscillators.
 	* This must be done after all the oscillators have been clock()'ed,
@@ -276,6 +308,22 @@ public:
 	*/
 	void reset ();
 
+	/**
+	* Save or restore the oscillator state.
+	* The waveform tables are looked up again from the restored waveform.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( pw, shift_register, shift_latch, shift_pipeline, ring_msb_mask );
+		ar ( no_noise, noise_output, no_noise_or_noise_output, no_pulse, pulse_output );
+		ar ( waveform, waveform_output, accumulator, freq, tri_saw_pipeline, osc3 );
+		ar ( shift_register_reset, floating_output_ttl, test, sync, test_or_reset, msb_rising );
+
+		if constexpr ( Archive::loading )
+			set_waveform_tables ();
+	}
+
 	/**
 	* 12-bit waveform output.
 	*
@@ -324,15 +372,7 @@ public:
 		{
 			// Age floating DAC input.
 			if ( floating_output_ttl && ( --floating_output_ttl == 0 ) )
-			{
-				constexpr auto	FLOATING_OUTPUT_FADE_6581R3 = 1400u;
-				constexpr auto	FLOATING_OUTPUT_FADE_8580R5 = 50000u;
-
-				waveform_output &= waveform_output >> 1;
-				osc3 = waveform_output;
-				if ( waveform_output )
-					floating_output_ttl = is6581 ? FLOATING_OUTPUT_FADE_6581R3 : FLOATING_OUTPUT_FADE_8580R5;
-			}
+				fadeFloatingOutput ();
 		}
 
 		// The pulse level is defined as (accumulator >> 12) >= pw ? 0xfff : 0x000.
@@ -0,0 +1,157 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "BlockResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Kaiser.h"
+#include "SoftClip.h"
+
+#if ! defined __APPLE__
+constexpr auto	M_PI = 3.14159265358979323846;
+#endif
+
+namespace reSIDfp
+{
+
+//-----------------------------------------------------------------------------
+
+void BlockResampler::setup ( double clockFrequency, double samplingFrequency, int bits )
+{
+	// Same passband and intermediate frequency as the TwoPassSincResampler
+	const auto	halfFreq = ( samplingFrequency > 44000.0 ) ? 20000.0 : samplingFrequency * 0.45;
+
+	const auto	intermediateFrequency = 2.0 * halfFreq
+		+	std::sqrt	( 2.0 * halfFreq * clockFrequency
+							* ( samplingFrequency - 2.0 * halfFreq ) / samplingFrequency
+						);
+
+	// Round down, a higher intermediate rate only widens the transition band of the first stage
+	decimation = std::max ( 1, int ( clockFrequency / intermediateFrequency ) );
+
+	const auto	decimatedFrequency = clockFrequency / decimation;
+
+	// 16 bits -> -96dB stopband attenuation
+	const auto	A = -20.0 * std::log10 ( 1.0 / ( 1 << bits ) );
+
+	// Whatever aliases must land in the stopband of the second stage,
+	// which starts at the sampling rate minus the passband
+	const auto	stopFreq = decimatedFrequency - ( samplingFrequency - halfFreq );
+	const auto	dw = ( stopFreq - halfFreq ) / clockFrequency * M_PI * 2.0;
+
+	const auto	beta = Kaiser::beta ( A );
+	const auto	I0beta = Kaiser::I0 ( beta );
+
+	firN = int ( ( A - 7.95 ) / ( 2.285 * dw ) + 1.0 ) | 1;
+	firStride = ( firN + Convolution::PADDING - 1 ) & ~( Convolution::PADDING - 1 );
+
+	constexpr auto	ALIGN = Convolution::ALIGNMENT / int ( sizeof ( int16_t ) );
+
+	firStorage.assign ( firStride + ALIGN, 0 );
+
+	const auto	offset = ( ALIGN - int ( ( uintptr_t ( firStorage.data () ) / sizeof ( int16_t ) ) & ( ALIGN - 1 ) ) ) & ( ALIGN - 1 );
+	firTable = firStorage.data () + offset;
+
+	// Cut off midway through the transition band
+	const auto	wc = ( stopFreq + halfFreq ) / clockFrequency * M_PI;
+	const auto	firN_2 = double ( firN / 2 );
+
+	for ( auto j = 0; j < firN; j++ )
+	{
+		const auto	x = j - firN_2;
+
+		const auto	xt = x / firN_2;
+		const auto	kaiserXt = Kaiser::window ( xt, beta, I0beta );
+
+		const auto	wt = wc * x;
+		const auto	sincWt = std::fabs ( wt ) >= 1e-8 ? std::sin ( wt ) / wt : 1.0;
+
+		firStorage[ offset + j ] = int16_t ( std::lround ( 32768.0 * wc / M_PI * sincWt * kaiserXt ) );
+	}
+
+	// The convolutions read up to the padding beyond the block
+	samples.assign ( firN - 1 + BLOCKSIZE + Convolution::PADDING, 0 );
+	phase = 0;
+
+	kernel = Convolution::getSelected ();
+
+	s2.setup ( decimatedFrequency, samplingFrequency, halfFreq, bits );
+}
+//-----------------------------------------------------------------------------
+
+int BlockResampler::decimate ( int count, int32_t* out )
+{
+	auto	n = 0;
+	auto	pos = phase;
+
+	for ( ; pos < count; pos += decimation )
+	{
+		// The window ends at the kept sample
+		const auto	value = ( kernel ( samples.data () + pos, firTable, firStride ) + ( 1 << 14 ) ) >> 15;
+
+		if ( s2.input ( value ) )
+			out[ n++ ] = s2.output ();
+	}
+
+	phase = pos - count;
+
+	// Keep the history for the next block
+	std::memmove ( samples.data (), samples.data () + count, size_t ( firN - 1 ) * sizeof ( int32_t ) );
+
+	return n;
+}
+//-----------------------------------------------------------------------------
+
+int BlockResampler::process ( int count, int16_t* out, int scaleFactor )
+{
+	// At most one output per cycle sample
+	int32_t	outputs[ BLOCKSIZE ];
+
+	const auto	n = decimate ( count, outputs );
+
+	SoftClip::clip ( outputs, out, n, scaleFactor );
+
+	return n;
+}
+//-----------------------------------------------------------------------------
+
+int BlockResampler::process ( int count, float* out, int scaleFactor )
+{
+	int32_t	outputs[ BLOCKSIZE ];
+
+	const auto	n = decimate ( count, outputs );
+
+	SoftClip::toFloat ( outputs, out, n, scaleFactor );
+
+	return n;
+}
+//-----------------------------------------------------------------------------
+
+void BlockResampler::reset ()
+{
+	std::fill ( samples.begin (), samples.end (), 0 );
+	phase = 0;
+
+	s2.reset ();
+}
+//-----------------------------------------------------------------------------
+
+} // namespace reSIDfp
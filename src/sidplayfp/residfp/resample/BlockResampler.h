@@ -0,0 +1,139 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <vector>
+
+#include "../../../EZ/config.h"
+#include "Convolution.h"
+#include "SincResampler.h"
+
+namespace reSIDfp
+{
+
+/**
+* Resampler working on blocks of cycle samples.
+*
+* The first stage decimates the clock rate by an integer factor down to
+* about the intermediate rate of the TwoPassSincResampler. As the ratio is
+* an integer, it is a single FIR computed only at the kept samples, straight
+* on the linear block without a ring buffer. The second stage is the usual
+* SincResampler, fed at the intermediate rate.
+*
+* By default both stages are designed for the same 96dB stopband attenuation
+* as the TwoPassSincResampler.
+*
+* The samples are written to input() and converted with process().
+*/
+class BlockResampler final
+{
+public:
+	/// Number of cycle samples per block
+	static constexpr int	BLOCKSIZE = 1024;
+
+private:
+	/// First stage filter, padded for the vector units
+	std::vector<int16_t>	firStorage;
+	const int16_t*			firTable = nullptr;
+
+	int firN = 0;
+
+	int firStride = 0;
+
+	/// Decimation factor of the first stage
+	int decimation = 1;
+
+	/// Cycle samples until the next output of the first stage
+	int phase = 0;
+
+	/// The last firN - 1 samples of the previous block, followed by the current block
+	std::vector<int32_t>	samples;
+
+	Convolution::kernel_t	kernel = nullptr;
+
+	SincResampler	s2;
+
+	/**
+	* Run both stages over a block, the outputs unscaled.
+	*/
+	int decimate ( int count, int32_t* out );
+
+public:
+	/**
+	* @param clockFrequency System clock frequency at Hz
+	* @param samplingFrequency Desired output sampling rate
+	* @param bits stopband attenuation in bits, 16 for -96dB, fewer for shorter filters
+	*/
+	void setup ( double clockFrequency, double samplingFrequency, int bits = 16 );
+
+	/**
+	* Where to write the next block of at most BLOCKSIZE cycle samples.
+	*/
+	[[ nodiscard ]] sidinline int32_t* input () { return samples.data () + firN - 1; }
+
+	/**
+	* Resample a block of cycle samples written to input().
+	*
+	* @param count number of cycle samples
+	* @param out output buffer
+	* @param scaleFactor volume scale
+	* @return number of samples produced
+	*/
+	int process ( int count, int16_t* out, int scaleFactor );
+
+	/**
+	* Resample a block of cycle samples written to input(), without clipping.
+	* Full scale of the 16 bit output is at 1.0.
+	*/
+	int process ( int count, float* out, int scaleFactor );
+
+	/**
+	* Advance the output phase as if a number of samples had been input.
+	*
+	* @param cycles number of cycle samples
+	* @return the number of output samples skipped
+	*/
+	sidinline unsigned int skip ( unsigned int cycles )
+	{
+		if ( cycles <= unsigned ( phase ) )
+		{
+			phase -= int ( cycles );
+			return 0;
+		}
+
+		const auto	outputs = ( cycles - unsigned ( phase ) - 1 ) / unsigned ( decimation ) + 1;
+
+		phase += int ( outputs ) * decimation - int ( cycles );
+		return s2.skip ( outputs );
+	}
+
+	void reset ();
+
+	/**
+	* Save or restore the history of the first stage and the second stage.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		ar ( phase );
+		ar.array ( samples.data (), size_t ( firN - 1 ) );
+		s2.serialize ( ar );
+	}
+};
+
+} // namespace reSIDfp
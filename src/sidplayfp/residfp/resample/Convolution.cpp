@@ -0,0 +1,272 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "Convolution.h"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define RESIDFP_X86
+	#include <immintrin.h>
+
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define RESIDFP_TARGET(isa)
+	#else
+		#define RESIDFP_TARGET(isa)	__attribute__ ( ( target ( isa ) ) )
+	#endif
+
+	// The AVX-512 headers of GCC 12 trip its own warnings
+	#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ == 12
+		#pragma GCC diagnostic ignored "-Wuninitialized"
+		#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+	#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+	#define RESIDFP_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace reSIDfp
+{
+
+//-----------------------------------------------------------------------------
+
+// Unsigned, so that overflows wrap around as in the vector units
+static int convolveScalar ( const int32_t* const __restrict__ a, const int16_t* const __restrict__ b, const int bLength )
+{
+	auto	out = 0u;
+
+	for ( auto i = 0; i < bLength; ++i )
+		out += unsigned ( a[ i ] ) * unsigned ( b[ i ] );
+
+	return int ( out );
+}
+//-----------------------------------------------------------------------------
+
+#ifdef RESIDFP_X86
+
+RESIDFP_TARGET ( "sse4.1" )
+static int convolveSSE41 ( const int32_t* const a, const int16_t* const b, const int bLength )
+{
+	auto	acc = _mm_setzero_si128 ();
+
+	for ( auto i = 0; i < bLength; i += 8 )
+	{
+		const auto	c = _mm_load_si128 ( reinterpret_cast<const __m128i*> ( b + i ) );
+
+		const auto	lo = _mm_mullo_epi32 ( _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( a + i ) ), _mm_cvtepi16_epi32 ( c ) );
+		const auto	hi = _mm_mullo_epi32 ( _mm_loadu_si128 ( reinterpret_cast<const __m128i*> ( a + i + 4 ) ), _mm_cvtepi16_epi32 ( _mm_srli_si128 ( c, 8 ) ) );
+
+		acc = _mm_add_epi32 ( acc, _mm_add_epi32 ( lo, hi ) );
+	}
+
+	acc = _mm_add_epi32 ( acc, _mm_shuffle_epi32 ( acc, 0x4E ) );
+	acc = _mm_add_epi32 ( acc, _mm_shuffle_epi32 ( acc, 0xB1 ) );
+
+	return _mm_cvtsi128_si32 ( acc );
+}
+//-----------------------------------------------------------------------------
+
+RESIDFP_TARGET ( "avx2" )
+static int convolveAVX2 ( const int32_t* const a, const int16_t* const b, const int bLength )
+{
+	auto	acc = _mm256_setzero_si256 ();
+
+	for ( auto i = 0; i < bLength; i += 16 )
+	{
+		const auto	c = _mm256_load_si256 ( reinterpret_cast<const __m256i*> ( b + i ) );
+
+		const auto	lo = _mm256_mullo_epi32 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i*> ( a + i ) ), _mm256_cvtepi16_epi32 ( _mm256_castsi256_si128 ( c ) ) );
+		const auto	hi = _mm256_mullo_epi32 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i*> ( a + i + 8 ) ), _mm256_cvtepi16_epi32 ( _mm256_extracti128_si256 ( c, 1 ) ) );
+
+		acc = _mm256_add_epi32 ( acc, _mm256_add_epi32 ( lo, hi ) );
+	}
+
+	auto	sum = _mm_add_epi32 ( _mm256_castsi256_si128 ( acc ), _mm256_extracti128_si256 ( acc, 1 ) );
+	sum = _mm_add_epi32 ( sum, _mm_shuffle_epi32 ( sum, 0x4E ) );
+	sum = _mm_add_epi32 ( sum, _mm_shuffle_epi32 ( sum, 0xB1 ) );
+
+	return _mm_cvtsi128_si32 ( sum );
+}
+//-----------------------------------------------------------------------------
+
+RESIDFP_TARGET ( "avx512f" )
+static int convolveAVX512 ( const int32_t* const a, const int16_t* const b, const int bLength )
+{
+	auto	acc = _mm512_setzero_si512 ();
+
+	for ( auto i = 0; i < bLength; i += 16 )
+	{
+		const auto	c = _mm512_cvtepi16_epi32 ( _mm256_load_si256 ( reinterpret_cast<const __m256i*> ( b + i ) ) );
+
+		acc = _mm512_add_epi32 ( acc, _mm512_mullo_epi32 ( _mm512_loadu_si512 ( a + i ), c ) );
+	}
+
+	// AVX-512F implies AVX2
+	auto	sum = _mm256_add_epi32 ( _mm512_castsi512_si256 ( acc ), _mm512_extracti64x4_epi64 ( acc, 1 ) );
+	auto	sum128 = _mm_add_epi32 ( _mm256_castsi256_si128 ( sum ), _mm256_extracti128_si256 ( sum, 1 ) );
+	sum128 = _mm_add_epi32 ( sum128, _mm_shuffle_epi32 ( sum128, 0x4E ) );
+	sum128 = _mm_add_epi32 ( sum128, _mm_shuffle_epi32 ( sum128, 0xB1 ) );
+
+	return _mm_cvtsi128_si32 ( sum128 );
+}
+//-----------------------------------------------------------------------------
+
+static bool supports ( Convolution::isa_t isa )
+{
+	#if defined(_MSC_VER) && !defined(__clang__)
+		int	info[ 4 ];
+
+		__cpuid ( info, 0 );
+		const auto	maxLeaf = info[ 0 ];
+
+		__cpuid ( info, 1 );
+		const auto	sse41 = ( info[ 2 ] & ( 1 << 19 ) ) != 0;
+		const auto	osxsave = ( info[ 2 ] & ( 1 << 27 ) ) != 0;
+
+		// The OS must save the vector registers on context switches
+		const auto	xcr0 = osxsave ? _xgetbv ( 0 ) : 0;
+		const auto	ymm = ( xcr0 & 0x06 ) == 0x06;
+		const auto	zmm = ( xcr0 & 0xE6 ) == 0xE6;
+
+		auto	avx2 = false;
+		auto	avx512 = false;
+
+		if ( maxLeaf >= 7 )
+		{
+			__cpuidex ( info, 7, 0 );
+			avx2 = ymm && ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+			avx512 = zmm && ( info[ 1 ] & ( 1 << 16 ) ) != 0;
+		}
+
+		switch ( isa )
+		{
+			case Convolution::isa_t::SSE41:		return sse41;
+			case Convolution::isa_t::AVX2:		return avx2;
+			case Convolution::isa_t::AVX512:	return avx512;
+			default:							return false;
+		}
+	#else
+		switch ( isa )
+		{
+			case Convolution::isa_t::SSE41:		return __builtin_cpu_supports ( "sse4.1" );
+			case Convolution::isa_t::AVX2:		return __builtin_cpu_supports ( "avx2" );
+			case Convolution::isa_t::AVX512:	return __builtin_cpu_supports ( "avx512f" );
+			default:							return false;
+		}
+	#endif
+}
+//-----------------------------------------------------------------------------
+
+#endif
+
+#ifdef RESIDFP_NEON
+
+static int convolveNEON ( const int32_t* const a, const int16_t* const b, const int bLength )
+{
+	auto	acc = vdupq_n_s32 ( 0 );
+
+	for ( auto i = 0; i < bLength; i += 8 )
+	{
+		const auto	c = vld1q_s16 ( b + i );
+
+		acc = vmlaq_s32 ( acc, vld1q_s32 ( a + i ), vmovl_s16 ( vget_low_s16 ( c ) ) );
+		acc = vmlaq_s32 ( acc, vld1q_s32 ( a + i + 4 ), vmovl_s16 ( vget_high_s16 ( c ) ) );
+	}
+
+	const auto	sum = vadd_s32 ( vget_low_s32 ( acc ), vget_high_s32 ( acc ) );
+	return vget_lane_s32 ( vpadd_s32 ( sum, sum ), 0 );
+}
+//-----------------------------------------------------------------------------
+
+#endif
+
+Convolution::kernel_t Convolution::getKernel ( isa_t isa )
+{
+	switch ( isa )
+	{
+		case isa_t::SCALAR:
+			return convolveScalar;
+
+		#ifdef RESIDFP_X86
+			case isa_t::SSE41:	return supports ( isa ) ? convolveSSE41 : nullptr;
+			case isa_t::AVX2:	return supports ( isa ) ? convolveAVX2 : nullptr;
+			case isa_t::AVX512:	return supports ( isa ) ? convolveAVX512 : nullptr;
+		#endif
+
+		#ifdef RESIDFP_NEON
+			case isa_t::NEON:	return convolveNEON;
+		#endif
+
+		default:
+			return nullptr;
+	}
+}
+//-----------------------------------------------------------------------------
+
+const char* Convolution::getName ( isa_t isa )
+{
+	switch ( isa )
+	{
+		case isa_t::SCALAR:	return "scalar";
+		case isa_t::SSE41:	return "SSE4.1";
+		case isa_t::AVX2:	return "AVX2";
+		case isa_t::AVX512:	return "AVX-512";
+		case isa_t::NEON:	return "NEON";
+		case isa_t::COUNT:	break;
+	}
+
+	return "";
+}
+//-----------------------------------------------------------------------------
+
+static std::atomic<Convolution::kernel_t>	selected = nullptr;
+
+Convolution::kernel_t Convolution::getSelected ()
+{
+	if ( const auto kernel = selected.load ( std::memory_order_relaxed ) )
+		return kernel;
+
+	// Widest first
+	for ( const auto isa : { isa_t::NEON, isa_t::AVX512, isa_t::AVX2, isa_t::SSE41, isa_t::SCALAR } )
+	{
+		if ( const auto kernel = getKernel ( isa ) )
+		{
+			selected = kernel;
+			return kernel;
+		}
+	}
+
+	return convolveScalar;
+}
+//-----------------------------------------------------------------------------
+
+bool Convolution::select ( isa_t isa )
+{
+	const auto	kernel = getKernel ( isa );
+	if ( ! kernel )
+		return false;
+
+	selected = kernel;
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+} // namespace reSIDfp
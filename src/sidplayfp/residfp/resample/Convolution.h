@@ -0,0 +1,78 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdint.h>
+
+namespace reSIDfp
+{
+
+/**
+* Dot products of the resampler, int32 samples by int16 coefficients.
+*
+* All kernels wrap around on overflow the same way, so they all give
+* the same result. The fastest one the CPU supports is picked on first use.
+*/
+namespace Convolution
+{
+	/**
+	* The length of the convolutions must be a multiple of this,
+	* the coefficients are padded with zeroes.
+	*/
+	constexpr int	PADDING = 16;
+
+	/**
+	* Alignment of the coefficient tables in bytes.
+	*/
+	constexpr int	ALIGNMENT = 64;
+
+	enum class isa_t
+	{
+		SCALAR,
+		SSE41,
+		AVX2,
+		AVX512,
+		NEON,
+		COUNT,
+	};
+
+	using kernel_t = int ( * ) ( const int32_t* samples, const int16_t* coefficients, int length );
+
+	/**
+	* Get the kernel for an instruction set.
+	*
+	* @return nullptr if not built in or not supported by the CPU
+	*/
+	[[ nodiscard ]] kernel_t getKernel ( isa_t isa );
+
+	[[ nodiscard ]] const char* getName ( isa_t isa );
+
+	/**
+	* Get the kernel used by the resamplers.
+	*/
+	[[ nodiscard ]] kernel_t getSelected ();
+
+	/**
+	* Use another instruction set, for comparing them.
+	*
+	* @return false if not supported, the selection is kept
+	*/
+	bool select ( isa_t isa );
+}
+
+} // namespace reSIDfp
@@ -0,0 +1,86 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <cmath>
+
+namespace reSIDfp
+{
+
+/**
+* The Kaiser window the FIR filters of the resamplers are built with.
+*
+* For calculation of beta and N see the reference for the Kaiser window function in the MATLAB Signal Processing Toolbox:
+* http://www.mathworks.com/help/signal/ref/kaiserord.html
+*/
+namespace Kaiser
+{
+	/**
+	* Compute the 0th order modified Bessel function of the first kind.
+	* This function is originally from resample-1.5/filterkit.c by J. O. Smith.
+	*
+	* @param x evaluate I0 at x
+	* @return value of I0 at x.
+	*/
+	[[ nodiscard ]] inline double I0 ( double x )
+	{
+		// Maximum error acceptable in I0 is 1e-6, or ~96 dB
+		constexpr auto	I0E = 1e-6;
+
+		auto	sum = 1.0;
+		auto	u = 1.0;
+		auto	n = 1.0;
+		const auto	halfx = x / 2.0;
+
+		do
+		{
+			const auto	temp = halfx / n;
+
+			u *= temp * temp;
+			sum += u;
+			n += 1.0;
+
+		} while ( u >= I0E * sum );
+
+		return sum;
+	}
+
+	/**
+	* Get the window shape parameter for a stopband attenuation.
+	*
+	* @param A attenuation in dB
+	*/
+	[[ nodiscard ]] inline double beta ( double A )
+	{
+		return 0.1102 * ( A - 8.7 );
+	}
+
+	/**
+	* Evaluate the window.
+	*
+	* @param xt position, -1 to 1 across the filter
+	* @param beta shape parameter, see #beta
+	* @param I0beta I0 ( beta ), the same for the whole filter
+	*/
+	[[ nodiscard ]] inline double window ( double xt, double beta, double I0beta )
+	{
+		return std::fabs ( xt ) < 1.0 ? I0 ( beta * std::sqrt ( 1. - xt * xt ) ) / I0beta : 0.0;
+	}
+}
+
+} // namespace reSIDfp
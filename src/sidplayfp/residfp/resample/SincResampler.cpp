@@ -23,10 +23,15 @@
 
 #include "SincResampler.h"
 
+#include "Kaiser.h"
+
 #include <cassert>
 #include <cmath>
+#include <map>
+#include <mutex>
 #include <numeric>
 #include <execution>
+#include <tuple>
 
 #if ! defined __APPLE__
 constexpr auto	M_PI = 3.14159265358979323846;
@@ -38,26 +43,16 @@ namespace reSIDfp
 * Calculate convolution with sample and sinc
 *
 * @param a sample buffer input
-* @param b sinc buffer
-* @param bLength length of the sinc buffer
+* @param b sinc buffer, padded to the stride
 * @return convolved result
 */
 //-----------------------------------------------------------------------------
 
 int SincResampler::fir ( int subcycle )
 {
-	auto convolve = [] ( const int32_t* const __restrict__ a, const int16_t* const __restrict__ b, const int bLength )
+	auto convolve = [ this ] ( const int32_t* const a, const int16_t* const b )
 	{
-		auto    out = 0;
-
-		#if __has_cpp_attribute( assume )
-			[[ assume ( bLength > 0 ) ]];
-		#endif
-
-		for ( auto i = 0; i < bLength; ++i )
-  			out += a[ i ] * b[ i ];
- 
-		return ( out + ( 1 << 14 ) ) >> 15;
+		return ( kernel ( a, b, firStride ) + ( 1 << 14 ) ) >> 15;
 	};
 
 	// Find the first of the nearest fir tables close to the phase
@@ -67,7 +62,7 @@ int SincResampler::fir ( int subcycle )
 	// Find firN most recent samples, plus one extra in case the FIR wraps
 	auto	sampleStart = sampleIndex - firN + RINGSIZE - 1;
 
-	const auto	v1 = convolve ( sample + sampleStart, firTable.data () + firTableFirst * firN, firN );
+	const auto	v1 = convolve ( sample + sampleStart, firTable + firTableFirst * firStride );
 
 	// Use next FIR table, wrap around to first FIR table using previous sample
 	if ( ++firTableFirst == firRES )
@@ -76,61 +71,69 @@ int SincResampler::fir ( int subcycle )
 		++sampleStart;
 	}
 
-	const auto	v2 = convolve ( sample + sampleStart, firTable.data () + firTableFirst * firN, firN );
+	const auto	v2 = convolve ( sample + sampleStart, firTable + firTableFirst * firStride );
 
 	// Linear interpolation between the sinc tables yields good approximation for the exact value
 	return v1 + ( firTableOffset * ( v2 - v1 ) >> 10 );
 }
 //-----------------------------------------------------------------------------
 
-void SincResampler::setup ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency )
+void SincResampler::setup ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency, int bits )
 {
 	reset ();
 
 	cyclesPerSample = int ( clockFrequency / samplingFrequency * 1024.0 );
 
-	// 16 bits -> -96dB stopband attenuation.
-	constexpr auto	BITS = 16;
-	const auto	A = -20.0 * std::log10 ( 1.0 / ( 1 << BITS ) );
+	firTableRef = getFirTable ( clockFrequency, samplingFrequency, highestAccurateFrequency, bits );
+	firTable = firTableRef->coefficients;
+	firRES = firTableRef->firRES;
+	firN = firTableRef->firN;
+	firStride = firTableRef->firStride;
 
-	// A fraction of the bandwidth is allocated to the transition band, which we double because we design the filter to transition halfway at Nyquist
-	const auto	dw = ( 1.0 - 2.0 * highestAccurateFrequency / samplingFrequency ) * M_PI * 2.0;
+	kernel = Convolution::getSelected ();
+}
+//-----------------------------------------------------------------------------
 
-	constexpr auto I0 = [] ( double x )
-	{
-		// Maximum error acceptable in I0 is 1e-6, or ~96 dB
-		constexpr auto	I0E = 1e-6;
-
-		/**
-		* Compute the 0th order modified Bessel function of the first kind.
-		* This function is originally from resample-1.5/filterkit.c by J. O. Smith.
-		* It is used to build the Kaiser window for resampling.
-		*
-		* @param x evaluate I0 at x
-		* @return value of I0 at x.
-		*/
-		auto	sum = 1.0;
-		auto	u = 1.0;
-		auto	n = 1.0;
-		const auto	halfx = x / 2.0;
-
-		do
-		{
-			const auto	temp = halfx / n;
+std::shared_ptr<const SincResampler::firTable_t> SincResampler::getFirTable ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency, int bits )
+{
+	using key_t = std::tuple<double, double, double, int>;
 
-			u *= temp * temp;
-			sum += u;
-			n += 1.0;
+	// Only the tables still in use are kept
+	static std::mutex									lock;
+	static std::map<key_t, std::weak_ptr<const firTable_t>>	tables;
 
-		} while ( u >= I0E * sum );
+	std::lock_guard	guard ( lock );
 
-		return sum;
-	};
+	std::erase_if ( tables, [] ( const auto& entry ) { return entry.second.expired (); } );
+
+	const key_t	key = { clockFrequency, samplingFrequency, highestAccurateFrequency, bits };
+
+	if ( const auto it = tables.find ( key ); it != tables.end () )
+		return it->second.lock ();
+
+	auto	table = buildFirTable ( clockFrequency, samplingFrequency, highestAccurateFrequency, bits );
+	tables.emplace ( key, table );
 
-	// For calculation of beta and N see the reference for the Kaiser window function in the MATLAB Signal Processing Toolbox:
-	// http://www.mathworks.com/help/signal/ref/kaiserord.html
-	const auto	beta = 0.1102 * ( A - 8.7 );
-	const auto	I0beta = I0 ( beta );
+	return table;
+}
+//-----------------------------------------------------------------------------
+
+std::shared_ptr<const SincResampler::firTable_t> SincResampler::buildFirTable ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency, int bits )
+{
+	auto	table = std::make_shared<firTable_t> ();
+
+	auto&	firRES = table->firRES;
+	auto&	firN = table->firN;
+
+	// 16 bits -> -96dB stopband attenuation.
+	const auto	A = -20.0 * std::log10 ( 1.0 / ( 1 << bits ) );
+
+	// A fraction of the bandwidth is allocated to the transition band, which we double because we design the filter to transition halfway at Nyquist
+	const auto	dw = ( 1.0 - 2.0 * highestAccurateFrequency / samplingFrequency ) * M_PI * 2.0;
+
+	// For calculation of beta and N see Kaiser.h
+	const auto	beta = Kaiser::beta ( A );
+	const auto	I0beta = Kaiser::I0 ( beta );
 	const auto	cyclesPerSampleD = clockFrequency / samplingFrequency;
 	const auto	r_cyclesPerSampleD = 1.0 / cyclesPerSampleD;
 
@@ -151,15 +154,21 @@ void SincResampler::setup ( double clockFrequency, double samplingFrequency, dou
 		assert ( firN < RINGSIZE );
 
 		// Error is bounded by err < 1.234 / L^2, so L = sqrt(1.234 / (2^-16)) = sqrt(1.234 * 2^16).
-		firRES = int ( std::ceil ( std::sqrt ( 1.234 * ( 1 << BITS ) ) * r_cyclesPerSampleD ) );
+		firRES = int ( std::ceil ( std::sqrt ( 1.234 * ( 1 << bits ) ) * r_cyclesPerSampleD ) );
 
 		// firN*firRES represent the total resolution of the sinc sampling. JOS
 		// recommends a length of 2^BITS, but we don't quite use that good a filter.
 		// The filter test program indicates that the filter performs well, though.
 	}
 
-	// Allocate memory for FIR table
-	firTable.resize ( firRES * firN );
+	// Allocate memory for FIR table, each filter padded with zeroes and aligned for the vector units
+	constexpr auto	ALIGN = Convolution::ALIGNMENT / int ( sizeof ( int16_t ) );
+
+	table->firStride = ( firN + Convolution::PADDING - 1 ) & ~( Convolution::PADDING - 1 );
+	table->storage.resize ( firRES * table->firStride + ALIGN );
+
+	const auto	offset = ( ALIGN - int ( ( uintptr_t ( table->storage.data () ) / sizeof ( int16_t ) ) & ( ALIGN - 1 ) ) ) & ( ALIGN - 1 );
+	table->coefficients = table->storage.data () + offset;
 
 	// The cutoff frequency is midway through the transition band, in effect the same as Nyquist
 	constexpr auto	wc = M_PI;
@@ -171,9 +180,9 @@ void SincResampler::setup ( double clockFrequency, double samplingFrequency, dou
 	const auto	tmp = firN / 2;
 	const auto	firN_2 = double ( tmp );
 
-	auto	dst = firTable.data ();
 	for ( auto i = 0; i < firRES; i++ )
 	{
+		auto		dst = table->storage.data () + offset + i * table->firStride;
 		const auto	jPhase = double ( i ) / firRES + firN_2;
 
 		for ( auto j = 0; j < firN; j++ )
@@ -181,7 +190,7 @@ void SincResampler::setup ( double clockFrequency, double samplingFrequency, dou
 			const auto	x = j - jPhase;
 
 			const auto	xt = x / firN_2;
-			const auto	kaiserXt = std::fabs ( xt ) < 1.0 ? I0 ( beta * std::sqrt ( 1. - xt * xt ) ) / I0beta : 0.0;
+			const auto	kaiserXt = Kaiser::window ( xt, beta, I0beta );
 
 			const auto	wt = wc * x * r_cyclesPerSampleD;
 			const auto	sincWt = std::fabs ( wt ) >= 1e-8 ? std::sin ( wt ) / wt : 1.0;
@@ -189,6 +198,8 @@ void SincResampler::setup ( double clockFrequency, double samplingFrequency, dou
 			*dst++ = int16_t ( scale * sincWt * kaiserXt );
 		}
 	}
+
+	return table;
 }
 //-----------------------------------------------------------------------------
 
@@ -22,10 +22,13 @@
 * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <vector>
 
 #include "../../../EZ/config.h"
+#include "Convolution.h"
 
 namespace reSIDfp
 {
@@ -51,8 +54,26 @@ private:
 	// Size of the ring buffer, must be a power of 2
 	static const int RINGSIZE = 2048;
 
-	// Table of the fir filter coefficients
-	std::vector<int16_t>	firTable;
+	struct firTable_t
+	{
+		/// Filter resolution
+		int firRES;
+
+		/// Filter length
+		int firN;
+
+		/// Distance of the filters, the length padded for the vector units
+		int firStride;
+
+		std::vector<int16_t>	storage;
+		const int16_t*			coefficients;	// Aligned in the storage
+	};
+
+	// Table of the fir filter coefficients, shared by all resamplers with the same parameters
+	std::shared_ptr<const firTable_t>	firTableRef;
+	const int16_t*						firTable = nullptr;
+
+	Convolution::kernel_t	kernel = nullptr;
 
 	int sampleIndex = 0;
 
@@ -62,16 +83,25 @@ private:
 	/// Filter length
 	int firN;
 
+	int firStride;
+
 	int cyclesPerSample = 0;
 
 	int sampleOffset = 0;
 
 	int outputValue = 0;
 
-	int32_t	sample[ RINGSIZE * 2 ];
+	// The convolutions read up to the padding beyond the ring
+	int32_t	sample[ RINGSIZE * 2 + Convolution::PADDING ];
 
 	int fir ( int subcycle );
 
+	/**
+	* Get the table for the parameters from the tables in use, or build it.
+	*/
+	[[ nodiscard ]] static std::shared_ptr<const firTable_t> getFirTable ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency, int bits );
+	[[ nodiscard ]] static std::shared_ptr<const firTable_t> buildFirTable ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency, int bits );
+
 public:
 	/**
 	* Use a clock freqency of 985248Hz for PAL C64, 1022730Hz for NTSC C64.
@@ -87,8 +117,9 @@ public:
 	* @param clockFrequency System clock frequency at Hz
 	* @param samplingFrequency Desired output sampling rate
 	* @param highestAccurateFrequency passband frequency limit
+	* @param bits stopband attenuation in bits, 16 for -96dB, fewer for shorter filters
 	*/
-	void setup ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency );
+	void setup ( double clockFrequency, double samplingFrequency, double highestAccurateFrequency, int bits = 16 );
 
 	[[ nodiscard ]] sidinline bool input ( const int input )
 	{
@@ -111,7 +142,42 @@ public:
 
 	[[ nodiscard ]] sidinline int output () const { return outputValue; }
 
+	/**
+	* Advance the output phase as if a number of samples had been input.
+	*
+	* @param samples number of input samples
+	* @return the number of output samples skipped
+	*/
+	sidinline unsigned int skip ( unsigned int samples )
+	{
+		auto	outputs = 0u;
+
+		while ( samples )
+		{
+			if ( sampleOffset >= 1024 )
+			{
+				const auto	steps = std::min ( samples, unsigned ( sampleOffset - 1024 ) / 1024 + 1 );
+
+				sampleOffset -= int ( steps ) * 1024;
+				samples -= steps;
+				continue;
+			}
+
+			sampleOffset += cyclesPerSample - 1024;
+			samples--;
+			outputs++;
+		}
+
+		return outputs;
+	}
+
 	void reset ();
+
+	/**
+	* Save or restore the sample ring and the output phase.
+	*/
+	template<class Archive>
+	void serialize ( Archive& ar ) { ar ( sampleIndex, sampleOffset, outputValue, sample ); }
 };
 
 } // namespace reSIDfp
@@ -0,0 +1,130 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdint.h>
+
+#include "../../../EZ/config.h"
+
+namespace reSIDfp
+{
+
+/**
+* Clip the resampler output as it may overflow the 16 bit range.
+*
+* Approximate measured input ranges:
+* 6581: [-24262,+25080]  (Kawasaki_Synthesizer_Demo)
+* 8580: [-21514,+35232]  (64_Forever, Drum_Fool)
+*/
+namespace SoftClip
+{
+	constexpr auto	max16 = float ( std::numeric_limits<int16_t>::max () );
+
+	/// Below this the samples pass unchanged
+	constexpr auto	threshold = int ( max16 * 0.85454f );
+
+	[[ nodiscard ]] inline int16_t clip ( const int x )
+	{
+		const auto	abs_x = std::abs ( x );
+		if ( abs_x < threshold )
+			return int16_t ( x );
+
+		constexpr auto	t = threshold / max16;
+		constexpr auto	a = 1.0f - t;
+		constexpr auto	b = 1.0f / a;
+
+		auto	value = float ( abs_x - threshold ) / max16;
+		value = t + a * std::tanh ( b * value );
+
+		return int16_t ( value * ( x < 0 ? -max16 : max16 ) );
+	}
+
+	/**
+	* Clip a float sample, full scale at 1.0, along the same curve.
+	*/
+	[[ nodiscard ]] inline float clip ( const float x )
+	{
+		constexpr auto	t = threshold / max16;
+		const auto	abs_x = std::abs ( x );
+		if ( abs_x < t )
+			return x;
+
+		constexpr auto	a = 1.0f - t;
+		constexpr auto	b = 1.0f / a;
+
+		const auto	value = t + a * std::tanh ( b * ( abs_x - t ) );
+
+		return x < 0.0f ? -value : value;
+	}
+
+	/**
+	* Scale a resampler output to float without clipping,
+	* full scale of the 16 bit output at 1.0.
+	*/
+	[[ nodiscard ]] inline float toFloat ( const int scaleFactor, const int x )
+	{
+		return float ( scaleFactor * x ) * ( 0.5f / 32768.0f );
+	}
+
+	/**
+	* Scale a block of resampler outputs to float without clipping.
+	*/
+	inline void toFloat ( const int32_t* __restrict__ in, float* __restrict__ out, int count, int scaleFactor )
+	{
+		for ( auto i = 0; i < count; i++ )
+			out[ i ] = toFloat ( scaleFactor, in[ i ] );
+	}
+
+	/**
+	* Scale and clip a block of samples.
+	* The scaling and the range check vectorize, the curve is only taken
+	* for the rare blocks that get near full scale.
+	*
+	* @param in resampler output
+	* @param out clipped samples
+	* @param count number of samples
+	* @param scaleFactor volume scale, applied as in ( scaleFactor * x ) >> 1
+	*/
+	inline void clip ( int32_t* __restrict__ in, int16_t* __restrict__ out, int count, int scaleFactor )
+	{
+		auto	peak = 0;
+
+		for ( auto i = 0; i < count; i++ )
+		{
+			in[ i ] = ( scaleFactor * in[ i ] ) >> 1;
+			peak = std::max ( peak, std::abs ( in[ i ] ) );
+		}
+
+		if ( peak < threshold )
+		{
+			for ( auto i = 0; i < count; i++ )
+				out[ i ] = int16_t ( in[ i ] );
+
+			return;
+		}
+
+		for ( auto i = 0; i < count; i++ )
+			out[ i ] = clip ( in[ i ] );
+	}
+}
+
+} // namespace reSIDfp
@@ -25,6 +25,7 @@
 #include <memory>
 
 #include "SincResampler.h"
+#include "SoftClip.h"
 
 namespace reSIDfp
 {
@@ -60,35 +61,28 @@ public:
 		return s1.input ( sample ) && s2.input ( s1.output () );
 	}
 
-	[[ nodiscard ]] sidinline int16_t output ( const int scaleFactor ) const
+	/**
+	* Advance the output phase as if a number of samples had been input.
+	*
+	* @param samples number of input samples
+	* @return the number of output samples skipped
+	*/
+	sidinline unsigned int skip ( unsigned int samples )
 	{
-		/*
-		* Clip the input as it may overflow the 16 bit range.
-		*
-		* Approximate measured input ranges:
-		* 6581: [-24262,+25080]  (Kawasaki_Synthesizer_Demo)
-		* 8580: [-21514,+35232]  (64_Forever, Drum_Fool)
-		*/
-		auto softClip = [] ( const int x ) -> int16_t
-		{
-			constexpr auto	max16 = float ( std::numeric_limits<int16_t>::max () );
-			constexpr auto	threshold = int ( max16 * 0.85454f );
-			const auto	abs_x = std::abs ( x );
-			if ( abs_x < threshold )
-				return int16_t ( x );
-
-			constexpr auto	t = threshold / max16;
-			constexpr auto	a = 1.0f - t;
-			constexpr auto	b = 1.0f / a;
-
-			auto	value = float ( abs_x - threshold ) / max16;
-			value = t + a * std::tanh ( b * value );
+		return s2.skip ( s1.skip ( samples ) );
+	}
 
-			return int16_t ( value * ( x < 0 ? -max16 : max16 ) );
-		};
+	[[ nodiscard ]] sidinline int16_t output ( const int scaleFactor ) const
+	{
+		return SoftClip::clip ( ( scaleFactor * s2.output () ) >> 1 );
+	}
 
-		const auto	out = ( scaleFactor * s2.output () ) >> 1;
-		return softClip ( out );
+	/**
+	* The output unclipped, full scale of the 16 bit output at 1.0.
+	*/
+	[[ nodiscard ]] sidinline float outputFloat ( const int scaleFactor ) const
+	{
+		return SoftClip::toFloat ( scaleFactor, s2.output () );
 	}
 
 	void reset ()
@@ -97,6 +91,13 @@ public:
 		s2.reset ();
 	}
 
+	template<class Archive>
+	void serialize ( Archive& ar )
+	{
+		s1.serialize ( ar );
+		s2.serialize ( ar );
+	}
+
 private:
 	SincResampler	s1;
 	SincResampler	s2;
@@ -0,0 +1,126 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <algorithm>
+
+#include "../../../EZ/config.h"
+#include "SoftClip.h"
+
+namespace reSIDfp
+{
+
+/**
+* Return the sample at the output time, linearly interpolated between
+* the two nearest cycles.
+*
+* There is no anti-aliasing filter, everything above half the sampling
+* frequency folds back into the output. Only meant for previews.
+*/
+class ZeroOrderResampler final
+{
+private:
+	/// Last sample
+	int cachedSample = 0;
+
+	/// Number of cycles per sample
+	int cyclesPerSample = 0;
+
+	int sampleOffset = 0;
+
+	/// Calculated sample
+	int outputValue = 0;
+
+public:
+	void setup ( double clockFrequency, double samplingFrequency )
+	{
+		reset ();
+
+		cyclesPerSample = int ( clockFrequency / samplingFrequency * 1024.0 );
+	}
+
+	[[ nodiscard ]] sidinline bool input ( const int sample )
+	{
+		auto	ready = false;
+
+		if ( sampleOffset < 1024 )
+		{
+			outputValue = cachedSample + ( sampleOffset * ( sample - cachedSample ) >> 10 );
+			ready = true;
+			sampleOffset += cyclesPerSample;
+		}
+
+		sampleOffset -= 1024;
+		cachedSample = sample;
+
+		return ready;
+	}
+
+	[[ nodiscard ]] sidinline int16_t output ( const int scaleFactor ) const
+	{
+		return SoftClip::clip ( ( scaleFactor * outputValue ) >> 1 );
+	}
+
+	/**
+	* The output unclipped, full scale of the 16 bit output at 1.0.
+	*/
+	[[ nodiscard ]] sidinline float outputFloat ( const int scaleFactor ) const
+	{
+		return SoftClip::toFloat ( scaleFactor, outputValue );
+	}
+
+	/**
+	* Advance the output phase as if a number of samples had been input.
+	*
+	* @param samples number of input samples
+	* @return the number of output samples skipped
+	*/
+	sidinline unsigned int skip ( unsigned int samples )
+	{
+		auto	outputs = 0u;
+
+		while ( samples )
+		{
+			if ( sampleOffset >= 1024 )
+			{
+				const auto	steps = std::min ( samples, unsigned ( sampleOffset - 1024 ) / 1024 + 1 );
+
+				sampleOffset -= int ( steps ) * 1024;
+				samples -= steps;
+				continue;
+			}
+
+			sampleOffset += cyclesPerSample - 1024;
+			samples--;
+			outputs++;
+		}
+
+		return outputs;
+	}
+
+	void reset ()
+	{
+		cachedSample = 0;
+		sampleOffset = 0;
+	}
+
+	template<class Archive>
+	void serialize ( Archive& ar ) { ar ( cachedSample, sampleOffset, outputValue ); }
+};
+
+} // namespace reSIDfp
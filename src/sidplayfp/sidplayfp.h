@@ -156,6 +156,29 @@ public:
 	 * @return false if the requested chip doesn't exist.
 	 * @since 2.2
 	 */
-	bool getSidStatus ( int sidNum, uint8_t regs[ 32 ] ) {	return sidplayer.getSidStatus ( sidNum, regs );	}
+	bool getSidStatus ( int sidNum, uint8_t regs[ 32 ] ) const {	return sidplayer.getSidStatus ( sidNum, regs );	}
+
+	/**
+	 * Get the state of all SIDs as of the end of the last #play, safe to call from any thread.
+	 *
+	 * @param status registers, envelopes and voice 3 outputs of the chips
+	 * @return false before a tune is loaded.
+	 */
+	bool getSidStatus ( libsidplayfp::SidStatus& status ) const {	return sidplayer.getSidStatus ( status );	}
+
+	/**
+	 * Capture the outputs of the voices and the filter of each SID while playing, for oscilloscopes.
+	 *
+	 * @param rate sampling rate of the capture in Hertz, 0 disables it.
+	 * @param length samples kept per channel.
+	 */
+	void setScope ( double rate, unsigned int length ) {	sidplayer.setScope ( rate, length );	}
+
+	/**
+	 * Get the latest captured samples of a voice, or of the filter output with channel 3.
+	 *
+	 * @return the number of samples copied.
+	 */
+	uint32_t getScope ( int sidNum, int channel, float* buffer, uint32_t samples ) const {	return sidplayer.getScope ( sidNum, channel, buffer, samples );	}
 };
 //-----------------------------------------------------------------------------
@@ -0,0 +1,138 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdint.h>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace libsidplayfp
+{
+
+/**
+* State of the SIDs for visualisers, as of the end of a call of the player.
+*/
+struct SidStatus final
+{
+	uint64_t	frame = 0;						// Counts the published states, starting at 1
+	uint32_t	timeMs = 0;						// Playing time
+	uint16_t	interruptCycles = 0;			// Cycles taken by the last interrupt of the tune
+	uint16_t	cia1TimerA = 0;					// Programmed value of CIA 1 timer A
+	uint8_t		chips = 0;
+
+	uint8_t		registers[ 3 ][ 0x20 ] = {};	// Last values written
+	uint8_t		osc3[ 3 ] = {};					// Voice 3 oscillator, as read from $1b
+	uint8_t		env3[ 3 ] = {};					// Voice 3 envelope, as read from $1c
+	float		envelopes[ 3 ][ 3 ] = {};		// Envelope level of each voice, 0 to 1
+};
+
+/**
+* Hand SidStatus over from the emulation thread to any number of readers.
+*
+* A seqlock over a few slots. The writer fills the slot after the latest one,
+* bumping its sequence number before and after, readers copy the latest slot and
+* check the number didn't change meanwhile. A reader only has to retry if the
+* writer comes around to the very same slot while it copies, which takes that
+* many publishes, so in practice reading never waits.
+*
+* The slots are copied as relaxed atomic words, there are no data races.
+*/
+class SidStatusBoard final
+{
+private:
+	static_assert ( std::is_trivially_copyable_v<SidStatus> );
+
+	static constexpr auto	SLOTS = 4u;
+	static constexpr auto	WORDS = ( sizeof ( SidStatus ) + sizeof ( uint64_t ) - 1 ) / sizeof ( uint64_t );
+
+	struct alignas ( 64 ) slot_t final
+	{
+		std::atomic<uint64_t>	sequence = 0;
+		std::atomic<uint64_t>	words[ WORDS ] = {};
+	};
+
+	slot_t	slots[ SLOTS ];
+
+	// Frame of the latest slot written, 0 for none
+	std::atomic<uint64_t>	latest = 0;
+
+public:
+	/**
+	* Publish a state, from one thread only.
+	*
+	* @param status the state, its frame is set
+	*/
+	void publish ( SidStatus& status )
+	{
+		const auto	frame = latest.load ( std::memory_order_relaxed ) + 1;
+		status.frame = frame;
+
+		uint64_t	words[ WORDS ] = {};
+		std::memcpy ( words, &status, sizeof ( SidStatus ) );
+
+		auto&		slot = slots[ frame % SLOTS ];
+		const auto	sequence = slot.sequence.load ( std::memory_order_relaxed );
+
+		slot.sequence.store ( sequence + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence ( std::memory_order_release );
+
+		for ( auto i = 0u; i < WORDS; i++ )
+			slot.words[ i ].store ( words[ i ], std::memory_order_relaxed );
+
+		slot.sequence.store ( sequence + 2, std::memory_order_release );
+		latest.store ( frame, std::memory_order_release );
+	}
+
+	/**
+	* Get the latest state, from any thread.
+	*
+	* @return false if nothing is published yet
+	*/
+	bool read ( SidStatus& status ) const
+	{
+		for ( ;; )
+		{
+			const auto	frame = latest.load ( std::memory_order_acquire );
+			if ( frame == 0 )
+				return false;
+
+			const auto&	slot = slots[ frame % SLOTS ];
+			const auto	sequence = slot.sequence.load ( std::memory_order_acquire );
+
+			// Being written
+			if ( sequence & 1 )
+				continue;
+
+			uint64_t	words[ WORDS ];
+
+			for ( auto i = 0u; i < WORDS; i++ )
+				words[ i ] = slot.words[ i ].load ( std::memory_order_relaxed );
+
+			std::atomic_thread_fence ( std::memory_order_acquire );
+
+			if ( slot.sequence.load ( std::memory_order_relaxed ) == sequence )
+			{
+				std::memcpy ( &status, words, sizeof ( SidStatus ) );
+				return true;
+			}
+		}
+	}
+};
+
+}
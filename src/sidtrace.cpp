@@ -0,0 +1,226 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "sidtrace.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libsidplayfp
+{
+
+//-----------------------------------------------------------------------------
+
+bool SidTrace::record ( uint8_t header, event_clock_t clk )
+{
+	if ( stream && data.size () >= BLOCKSIZE )
+		flush ();
+
+	// Stop before a record which may not fit, so the data ends with a whole one
+	if ( ! stream && ( full || data.size () + MAXRECORD > capacity ) )
+	{
+		full = true;
+		return false;
+	}
+
+	// Restoring an older state can move the clock backwards, keep the order
+	const auto	delta = uint64_t ( clk > lastClk ? clk - lastClk : 0 );
+	lastClk = std::max ( clk, lastClk );
+
+	data.push_back ( header );
+	varint ( delta );
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::varint ( uint64_t value )
+{
+	while ( value >= 0x80 )
+	{
+		data.push_back ( uint8_t ( value | 0x80 ) );
+		value >>= 7;
+	}
+	data.push_back ( uint8_t ( value ) );
+}
+//-----------------------------------------------------------------------------
+
+bool SidTrace::control ( kind_t kind, event_clock_t clk, int chip )
+{
+	return record ( uint8_t ( CONTROL | chip << 3 | uint8_t ( kind ) ), clk );
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::write ( event_clock_t clk, int chip, uint8_t addr, uint8_t value )
+{
+	if ( record ( uint8_t ( chip << 5 | ( addr & 0x1f ) ), clk ) )
+		data.push_back ( value );
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::read ( event_clock_t clk, int chip, uint8_t addr, uint8_t value )
+{
+	if ( ! control ( kind_t::READ, clk, chip ) )
+		return;
+
+	data.push_back ( addr & 0x1f );
+	data.push_back ( value );
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::reset ( int chip, uint8_t volume )
+{
+	lastClk = 0;
+
+	if ( control ( kind_t::RESET, 0, chip ) )
+		data.push_back ( volume );
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::time ( event_clock_t clk, uint32_t samples, bool dropped )
+{
+	if ( control ( kind_t::TIME, clk, dropped ? 1 : 0 ) )
+		varint ( samples );
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::mode ( event_clock_t clk, int chip, kind_t kind, bool enable )
+{
+	if ( control ( kind, clk, chip ) )
+		data.push_back ( enable );
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::setting ( event_clock_t clk, int chip, setting_t id, uint8_t arg, double param )
+{
+	if ( ! control ( kind_t::SETTING, clk, chip ) )
+		return;
+
+	data.push_back ( uint8_t ( id ) );
+	data.push_back ( arg );
+
+	const auto	pos = data.size ();
+	data.resize ( pos + sizeof ( param ) );
+	std::memcpy ( data.data () + pos, &param, sizeof ( param ) );
+}
+//-----------------------------------------------------------------------------
+
+void SidTrace::flush ()
+{
+	if ( ! stream || data.empty () )
+		return;
+
+	fwrite ( data.data (), 1, data.size (), stream );
+	data.clear ();
+}
+//-----------------------------------------------------------------------------
+
+bool SidTraceReader::varint ( uint64_t& value )
+{
+	value = 0;
+
+	for ( auto shift = 0; shift < 64; shift += 7 )
+	{
+		if ( pos >= end )
+			return false;
+
+		const auto	b = *pos++;
+		value |= uint64_t ( b & 0x7f ) << shift;
+		if ( ! ( b & 0x80 ) )
+			return true;
+	}
+
+	return false;
+}
+//-----------------------------------------------------------------------------
+
+bool SidTraceReader::next ( record_t& rec )
+{
+	if ( pos >= end )
+		return false;
+
+	const auto	header = *pos++;
+
+	uint64_t	delta;
+	if ( ! varint ( delta ) )
+		return false;
+
+	rec.cycles = event_clock_t ( delta );
+	rec.addr = 0;
+	rec.value = 0;
+	rec.samples = 0;
+	rec.param = 0.0;
+
+	if ( ( header & SidTrace::CONTROL ) == SidTrace::CONTROL )
+	{
+		rec.kind = SidTrace::kind_t ( header & 7 );
+		rec.chip = ( header >> 3 ) & 3;
+	}
+	else
+	{
+		rec.kind = SidTrace::kind_t::WRITE;
+		rec.chip = header >> 5;
+		rec.addr = header & 0x1f;
+	}
+
+	switch ( rec.kind )
+	{
+		case SidTrace::kind_t::TIME:
+		{
+			uint64_t	samples;
+			if ( ! varint ( samples ) )
+				return false;
+
+			rec.samples = uint32_t ( samples );
+			break;
+		}
+
+		case SidTrace::kind_t::SKIP:
+			break;
+
+		case SidTrace::kind_t::SETTING:
+			if ( end - pos < 2 + int ( sizeof ( rec.param ) ) )
+				return false;
+
+			rec.addr = *pos++;
+			rec.value = *pos++;
+			std::memcpy ( &rec.param, pos, sizeof ( rec.param ) );
+			pos += sizeof ( rec.param );
+			break;
+
+		case SidTrace::kind_t::READ:
+			if ( pos + 2 > end )
+				return false;
+
+			rec.addr = *pos++;
+			rec.value = *pos++;
+			break;
+
+		default:
+			if ( pos >= end )
+				return false;
+
+			rec.value = *pos++;
+			break;
+	}
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,228 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdint.h>
+#include <cstdio>
+#include <vector>
+
+#include "Event.h"
+
+namespace libsidplayfp
+{
+
+/**
+* Capture of the SID register accesses, stamped with the cycle they happen at.
+*
+* The trace is a byte stream of records, each one being
+*
+*  - a header byte: bits 0-4 register, bits 5-6 chip (0-2),
+*    chip 3 marks a control record with bits 0-2 the kind and bits 3-4 the chip
+*  - the cycles elapsed since the previous record, as LEB128 varint
+*  - the value written, or the control argument
+*
+* Control records are
+*
+*  - RESET: the chip is reset and its volume register set to the argument,
+*    the cycle count restarts from 0 with the machine
+*  - TIME: a call of #Player::play ends here, the argument is a varint
+*    with the number of samples it returned. With chip 1 the samples are
+*    mixed the same way and dropped, as when seeking to an exact position
+*  - SKIP: the samples produced up to here are discarded, as during
+*    the tune initialisation and seeking
+*  - READ: the register in the argument is read, followed by the value returned
+*  - FASTFORWARD, SETTLE: the chip mode is switched on or off
+*  - SETTING: a chip setting changes, followed by its #setting_t,
+*    a byte and a double argument in native byte order
+*
+* A typical write takes 3 bytes. Cycles are counted at PHI1, the moment
+* the access reaches the chip, so replaying the records into a SID clocked for
+* the deltas reproduces its output exactly, see #TraceRenderer.
+*
+* Captures into memory are limited to a capacity. Once reached, the capture stops
+* at the last whole record and #isFull reports it, the records up to there still
+* replay as a shorter trace. Captures into a stream are only limited by the stream.
+*/
+class SidTrace final
+{
+public:
+	enum class kind_t : uint8_t
+	{
+		WRITE,
+		RESET,
+		TIME,
+		SKIP,
+		READ,
+		FASTFORWARD,
+		SETTLE,
+		SETTING
+	};
+
+	enum class setting_t : uint8_t
+	{
+		MODEL,				// SidConfig::sid_model_t in the byte
+		CPUFREQ,			// SidConfig::sampling_method_t in the byte, clock
+		COMBINEDWAVEFORMS,	// reSIDfp::CombinedWaveforms in the byte, threshold
+		FILTER6581CURVE,
+		FILTER6581RANGE,
+		FILTER6581GAIN,
+		FILTER6581DIGI,
+		VOICE6581DCDRIFT,
+		FILTER8580CURVE,
+		DACLEAKAGE,
+
+		COUNT
+	};
+
+	static constexpr uint8_t	CONTROL = 3 << 5;
+
+private:
+	// Flush to the stream every this many bytes
+	static constexpr auto	BLOCKSIZE = 0x10000u;
+
+	// Longest record, a SETTING with a full varint delta
+	static constexpr auto	MAXRECORD = 1u + 10u + 2u + sizeof ( double );
+
+	std::vector<uint8_t>	data;
+	FILE*			stream = nullptr;
+
+	size_t			capacity = 0;
+	bool			full = false;
+
+	event_clock_t	lastClk = 0;
+
+	[[ nodiscard ]] bool record ( uint8_t header, event_clock_t clk );
+	void varint ( uint64_t value );
+	[[ nodiscard ]] bool control ( kind_t kind, event_clock_t clk, int chip );
+
+public:
+	static constexpr size_t	DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+	/**
+	* Capture into memory, see #getData.
+	*
+	* @param _capacity the most bytes to capture, about 20 million register writes by default
+	*/
+	explicit SidTrace ( size_t _capacity = DEFAULT_CAPACITY ) : capacity ( _capacity ) {}
+
+	/**
+	* Capture into an open binary stream, written in blocks.
+	* The stream stays owned by the caller.
+	*/
+	explicit SidTrace ( FILE* _stream ) : stream ( _stream ) {}
+
+	~SidTrace () { flush (); }
+
+	SidTrace ( const SidTrace& ) = delete;
+	SidTrace& operator= ( const SidTrace& ) = delete;
+
+	/**
+	* Log a register write.
+	*/
+	void write ( event_clock_t clk, int chip, uint8_t addr, uint8_t value );
+
+	/**
+	* Log a register read, along with the value returned.
+	*/
+	void read ( event_clock_t clk, int chip, uint8_t addr, uint8_t value );
+
+	/**
+	* Log a chip reset, the cycle count restarts from 0.
+	*/
+	void reset ( int chip, uint8_t volume );
+
+	/**
+	* Log the end of a call of the player which returned samples.
+	*
+	* @param dropped true if the samples were mixed only to be dropped
+	*/
+	void time ( event_clock_t clk, uint32_t samples, bool dropped = false );
+
+	/**
+	* Log that the samples produced up to now are discarded.
+	*/
+	void skip ( event_clock_t clk )		{	(void)control ( kind_t::SKIP, clk, 0 );	}
+
+	/**
+	* Log a switch of the fast forward or settle mode of a chip.
+	*/
+	void mode ( event_clock_t clk, int chip, kind_t kind, bool enable );
+
+	/**
+	* Log the change of a chip setting.
+	*/
+	void setting ( event_clock_t clk, int chip, setting_t id, uint8_t arg, double param );
+
+	/**
+	* Write out the pending records, when capturing into a stream.
+	*/
+	void flush ();
+
+	/**
+	* Drop the captured records.
+	*/
+	void clear () { data.clear (); full = false; lastClk = 0; }
+
+	/**
+	* Check if the capture into memory stopped at its capacity.
+	*/
+	[[ nodiscard ]] bool isFull () const { return full; }
+
+	/**
+	* Get the records captured into memory.
+	*/
+	[[ nodiscard ]] const std::vector<uint8_t>& getData () const { return data; }
+};
+//-----------------------------------------------------------------------------
+
+/**
+* Decoder for the records of a #SidTrace.
+*/
+class SidTraceReader final
+{
+public:
+	struct record_t
+	{
+		SidTrace::kind_t	kind;
+		event_clock_t		cycles;	// Since the previous record
+		int					chip;
+		uint8_t				addr;	// Register, or setting_t for SETTING
+		uint8_t				value;	// Value written or read, or control argument
+		uint32_t			samples;	// Returned by the player, for TIME
+		double				param;	// Argument of SETTING
+	};
+
+private:
+	const uint8_t*	pos;
+	const uint8_t*	end;
+
+	bool varint ( uint64_t& value );
+
+public:
+	SidTraceReader ( const uint8_t* data, size_t size ) : pos ( data ), end ( data + size ) {}
+	explicit SidTraceReader ( const std::vector<uint8_t>& data ) : SidTraceReader ( data.data (), data.size () ) {}
+
+	/**
+	* Decode the next record.
+	*
+	* @return false at the end of the data or on a truncated record
+	*/
+	bool next ( record_t& rec );
+};
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdint.h>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "EZ/config.h"
+
+namespace libsidplayfp
+{
+
+/**
+* Plain memory image of the whole emulator state.
+*/
+using Snapshot = std::vector<uint8_t>;
+
+/**
+* Archive appending the state of the components to a snapshot.
+*
+* Components implement a single `template<class Archive> void serialize ( Archive& ar )`
+* listing their state, which is used both for saving and restoring.
+* Derived values, like table pointers, are recomputed when `Archive::loading`.
+*/
+class SnapshotWriter final
+{
+private:
+	Snapshot&	data;
+
+	sidinline void put ( const void* value, size_t size )
+	{
+		const auto	pos = data.size ();
+		data.resize ( pos + size );
+		std::memcpy ( data.data () + pos, value, size );
+	}
+
+public:
+	static constexpr bool	loading = false;
+
+	explicit SnapshotWriter ( Snapshot& _data )
+		: data ( _data )
+	{
+		data.clear ();
+	}
+
+	/**
+	* Append plain values or arrays.
+	*/
+	template<typename... T>
+	sidinline void operator () ( const T&... values )
+	{
+		static_assert ( ( std::is_trivially_copyable_v<T> && ... ), "Only plain values can be archived" );
+		( put ( &values, sizeof ( T ) ), ... );
+	}
+
+	/**
+	* Append a run of values.
+	*/
+	template<typename T>
+	sidinline void array ( const T* values, size_t count )
+	{
+		static_assert ( std::is_trivially_copyable_v<T>, "Only plain values can be archived" );
+		put ( values, count * sizeof ( T ) );
+	}
+};
+
+/**
+* Archive restoring the state of the components from a snapshot.
+*/
+class SnapshotReader final
+{
+private:
+	const Snapshot&	data;
+	size_t			pos = 0;
+	bool			overrun = false;
+
+	sidinline void get ( void* value, size_t size )
+	{
+		if ( pos + size > data.size () )
+		{
+			std::memset ( value, 0, size );
+			overrun = true;
+			return;
+		}
+
+		std::memcpy ( value, data.data () + pos, size );
+		pos += size;
+	}
+
+public:
+	static constexpr bool	loading = true;
+
+	explicit SnapshotReader ( const Snapshot& _data )
+		: data ( _data )
+	{
+	}
+
+	/**
+	* Read plain values or arrays.
+	*/
+	template<typename... T>
+	sidinline void operator () ( T&... values )
+	{
+		static_assert ( ( std::is_trivially_copyable_v<T> && ... ), "Only plain values can be archived" );
+		( get ( &values, sizeof ( T ) ), ... );
+	}
+
+	/**
+	* Read a run of values.
+	*/
+	template<typename T>
+	sidinline void array ( T* values, size_t count )
+	{
+		static_assert ( std::is_trivially_copyable_v<T>, "Only plain values can be archived" );
+		get ( values, count * sizeof ( T ) );
+	}
+
+	/**
+	* Check that the whole snapshot has been consumed, and no more.
+	*/
+	[[ nodiscard ]] bool complete () const { return ! overrun && pos == data.size (); }
+};
+
+}
@@ -0,0 +1,295 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "tracerenderer.h"
+
+#include <algorithm>
+
+namespace libsidplayfp
+{
+
+//-----------------------------------------------------------------------------
+
+TraceRenderer::TraceRenderer ()
+	: m_stepEvent ( "Trace step", *this, &TraceRenderer::step )
+{
+}
+//-----------------------------------------------------------------------------
+
+bool TraceRenderer::load ( const uint8_t* data, size_t size, int sampleRate, bool stereo )
+{
+	// Default PAL clock, in case the trace doesn't start with the configuration
+	constexpr auto	CPUFREQ = 985248.0f;
+
+	if ( sampleRate < 8000 )
+	{
+		m_errorString = "TRACE ERROR: Unsupported sampling frequency.";
+		return false;
+	}
+
+	// The chips are the ones being reset
+	auto	chips = 0;
+	{
+		SidTraceReader				reader ( data, size );
+		SidTraceReader::record_t	rec;
+
+		while ( reader.next ( rec ) )
+			if ( rec.kind == SidTrace::kind_t::RESET )
+				chips = std::max ( chips, rec.chip + 1 );
+	}
+
+	if ( chips == 0 || chips > int ( Mixer::MAX_SIDS ) )
+	{
+		m_errorString = "TRACE ERROR: Unsupported number of SIDs.";
+		return false;
+	}
+
+	eventScheduler.reset ();
+
+	m_mixer.clearSids ();
+	m_sampleRate = sampleRate;
+	m_overrides.reset ();
+
+	for ( auto i = 0; i < chips; i++ )
+	{
+		m_sidEmu[ i ] = std::make_unique<sidemu> ( eventScheduler );
+		m_sidEmu[ i ]->sampling ( CPUFREQ, float ( sampleRate ) );
+
+		m_mixer.addSid ( m_sidEmu[ i ].get () );
+	}
+
+	m_mixer.setStereo ( stereo );
+	m_mixer.setSamplerate ( sampleRate );
+
+	m_reader = { data, size };
+	m_hasRecord = m_reader.next ( m_record );
+
+	m_output.clear ();
+	m_outputPos = 0;
+
+	m_readMismatches = 0;
+
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+uint32_t TraceRenderer::render ( int16_t* buffer, uint32_t count )
+{
+	auto	done = 0u;
+
+	while ( done < count )
+	{
+		if ( m_outputPos == m_output.size () )
+		{
+			if ( ! replayCall () )
+				break;
+
+			continue;
+		}
+
+		const auto	n = std::min ( size_t ( count - done ), m_output.size () - m_outputPos );
+
+		std::copy_n ( m_output.data () + m_outputPos, n, buffer + done );
+
+		m_outputPos += n;
+		done += uint32_t ( n );
+	}
+
+	return done;
+}
+//-----------------------------------------------------------------------------
+
+bool TraceRenderer::callEnd ( SidTraceReader::record_t& rec ) const
+{
+	auto	reader = m_reader;
+	rec = m_record;
+
+	for ( auto more = m_hasRecord; more; more = reader.next ( rec ) )
+		if ( rec.kind == SidTrace::kind_t::TIME || rec.kind == SidTrace::kind_t::SKIP )
+			return true;
+
+	return false;
+}
+//-----------------------------------------------------------------------------
+
+bool TraceRenderer::replayCall ()
+{
+	constexpr auto	CYCLES = 3000u;
+
+	m_output.clear ();
+	m_outputPos = 0;
+
+	// Records after the last call of the player, if the capture was cut, are dropped
+	SidTraceReader::record_t	end;
+	if ( ! callEnd ( end ) )
+	{
+		m_hasRecord = false;
+		return false;
+	}
+
+	if ( end.kind == SidTrace::kind_t::SKIP )
+	{
+		// Clock chips and discard buffers
+		while ( advance ( CYCLES ) )
+		{
+			m_mixer.clockChips ();
+			m_mixer.resetBufs ();
+		}
+		return true;
+	}
+
+	// Clock chips and mix into output buffer, leaving the same samples for the next call.
+	// Samples mixed only to be dropped, when seeking, are cleared again
+	m_output.resize ( end.samples );
+	m_mixer.begin ( m_output.data (), end.samples );
+
+	for ( auto more = true; more; )
+	{
+		more = advance ( CYCLES );
+
+		m_mixer.clockChips ();
+		m_mixer.doMix ();
+	}
+
+	m_output.resize ( end.chip ? 0 : m_mixer.samplesGenerated () );
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+bool TraceRenderer::advance ( unsigned int cycles )
+{
+	while ( m_hasRecord )
+	{
+		if ( m_record.cycles > 0 )
+		{
+			if ( cycles == 0 )
+				return true;
+
+			const auto	delta = unsigned ( std::min<event_clock_t> ( m_record.cycles, cycles ) );
+
+			eventScheduler.schedule ( m_stepEvent, delta, EVENT_CLOCK_PHI1 );
+			eventScheduler.run ( 1 );
+
+			m_record.cycles -= delta;
+			cycles -= delta;
+			continue;
+		}
+
+		const auto	kind = m_record.kind;
+
+		apply ( m_record );
+		m_hasRecord = m_reader.next ( m_record );
+
+		if ( kind == SidTrace::kind_t::TIME || kind == SidTrace::kind_t::SKIP )
+			return false;
+	}
+
+	return false;
+}
+//-----------------------------------------------------------------------------
+
+void TraceRenderer::apply ( const SidTraceReader::record_t& rec )
+{
+	// Accesses to chips which aren't there are dropped
+	auto	s = m_mixer.getSid ( rec.chip );
+
+	switch ( rec.kind )
+	{
+		case SidTrace::kind_t::WRITE:
+			if ( s )
+				s->poke ( rec.addr, rec.value );
+			break;
+
+		case SidTrace::kind_t::READ:
+			if ( s && s->peek ( rec.addr ) != rec.value )
+				m_readMismatches++;
+			break;
+
+		case SidTrace::kind_t::RESET:
+			// The machine restarts, along with its clock
+			eventScheduler.reset ();
+
+			if ( s )
+				s->reset ( rec.value );
+			break;
+
+		case SidTrace::kind_t::SKIP:
+			m_mixer.clockChips ();
+			m_mixer.resetBufs ();
+			break;
+
+		case SidTrace::kind_t::FASTFORWARD:
+			if ( s )
+			{
+				s->clock ();
+				s->fastForward ( rec.value );
+			}
+			break;
+
+		case SidTrace::kind_t::SETTLE:
+			if ( s )
+			{
+				s->clock ();
+				s->settle ( rec.value );
+			}
+			break;
+
+		case SidTrace::kind_t::SETTING:
+			if ( s && ! m_overrides.test ( rec.addr ) )
+			{
+				s->clock ();
+				applySetting ( *s, SidTrace::setting_t ( rec.addr ), rec.value, rec.param );
+			}
+			break;
+
+		case SidTrace::kind_t::TIME:
+			break;
+	}
+}
+//-----------------------------------------------------------------------------
+
+void TraceRenderer::applySetting ( sidemu& s, SidTrace::setting_t id, uint8_t arg, double param )
+{
+	switch ( id )
+	{
+		case SidTrace::setting_t::MODEL:				s.model ( SidConfig::sid_model_t ( arg ) );							break;
+		case SidTrace::setting_t::CPUFREQ:				s.sampling ( float ( param ), float ( m_sampleRate ), SidConfig::sampling_method_t ( arg ) );	break;
+		case SidTrace::setting_t::COMBINEDWAVEFORMS:	s.combinedWaveforms ( reSIDfp::CombinedWaveforms ( arg ), float ( param ) );	break;
+		case SidTrace::setting_t::FILTER6581CURVE:		s.filter6581Curve ( param );	break;
+		case SidTrace::setting_t::FILTER6581RANGE:		s.filter6581Range ( param );	break;
+		case SidTrace::setting_t::FILTER6581GAIN:		s.filter6581Gain ( param );		break;
+		case SidTrace::setting_t::FILTER6581DIGI:		s.filter6581Digi ( param );		break;
+		case SidTrace::setting_t::VOICE6581DCDRIFT:		s.voice6581DCDrift ( param );	break;
+		case SidTrace::setting_t::FILTER8580CURVE:		s.filter8580Curve ( param );	break;
+		case SidTrace::setting_t::DACLEAKAGE:			s.setDacLeakage ( param );		break;
+		case SidTrace::setting_t::COUNT:				break;
+	}
+}
+//-----------------------------------------------------------------------------
+
+void TraceRenderer::override ( SidTrace::setting_t id, uint8_t arg, double param )
+{
+	m_overrides.set ( size_t ( id ) );
+
+	for ( auto i = 0; i < m_mixer.getNumChips (); i++ )
+		if ( auto s = m_mixer.getSid ( i ) )
+			applySetting ( *s, id, arg, param );
+}
+//-----------------------------------------------------------------------------
+
+}
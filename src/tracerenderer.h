@@ -0,0 +1,153 @@
+#pragma once
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdint.h>
+#include <bitset>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "sidplayfp/SidConfig.h"
+#include "EventCallback.h"
+#include "EventScheduler.h"
+#include "sidemu.h"
+#include "mixer.h"
+#include "sidtrace.h"
+
+#include "EZ/config.h"
+
+namespace libsidplayfp
+{
+
+/**
+* Render the audio of a #SidTrace, driving the SIDs alone.
+*
+* No C64 is emulated, the chips are clocked straight to the cycle of each
+* recorded access and each recorded call of #Player::play is mixed again
+* the same way. The chip models and settings are taken from the trace,
+* so at the same sample rate the output is identical to the one of the player,
+* as tools/test-trace checks.
+* Overriding the settings re-renders the tune on another chip, as long as
+* the tune doesn't react to what it reads back from the SIDs, see #getReadMismatches.
+*/
+class TraceRenderer final
+{
+private:
+	EventScheduler	eventScheduler;
+
+	// Only event of the scheduler, marks the time to clock the chips to
+	EventCallback<TraceRenderer>	m_stepEvent;
+
+	// Created on load, so that no setting carries over from a previous trace
+	std::unique_ptr<sidemu>	m_sidEmu[ Mixer::MAX_SIDS ];
+	Mixer		m_mixer;
+
+	int			m_sampleRate = 0;
+
+	// Settings set here, the recorded ones are ignored
+	std::bitset<size_t ( SidTrace::setting_t::COUNT )>	m_overrides;
+
+	SidTraceReader				m_reader = { nullptr, 0 };
+	SidTraceReader::record_t	m_record = {};
+	bool						m_hasRecord = false;
+
+	// Samples of the last replayed call of the player
+	std::vector<int16_t>	m_output;
+	size_t					m_outputPos = 0;
+
+	uint32_t	m_readMismatches = 0;
+
+	std::string	m_errorString = "N/A";
+
+	void step () {}
+
+	// Find the record ending the next call of the player
+	[[ nodiscard ]] bool callEnd ( SidTraceReader::record_t& rec ) const;
+
+	// Apply the records up to a number of cycles ahead, false once the call of the player ended
+	bool advance ( unsigned int cycles );
+
+	// Render the next call of the player into m_output, false at the end of the trace
+	bool replayCall ();
+	void apply ( const SidTraceReader::record_t& rec );
+	void applySetting ( sidemu& s, SidTrace::setting_t id, uint8_t arg, double param );
+
+	// Apply a setting to all chips, in place of the recorded one
+	void override ( SidTrace::setting_t id, uint8_t arg, double param );
+
+public:
+	TraceRenderer ();
+
+	/**
+	* Set up the chips of a trace and rewind to its start.
+	*
+	* @param data the trace, must stay valid while rendering
+	* @param size size of the trace in bytes
+	* @param sampleRate output sample rate
+	* @param stereo true for interleaved stereo output
+	* @return false on bad parameters or a trace without chips, check #error
+	*/
+	bool load ( const uint8_t* data, size_t size, int sampleRate, bool stereo );
+	bool load ( const std::vector<uint8_t>& data, int sampleRate, bool stereo ) { return load ( data.data (), data.size (), sampleRate, stereo ); }
+
+	/**
+	* Render the next samples.
+	*
+	* @param buffer output buffer
+	* @param count size of the buffer in samples
+	* @return number of samples rendered, less than requested at the end of the trace
+	*/
+	uint32_t render ( int16_t* buffer, uint32_t count );
+
+	/**
+	* Check if the whole trace has been rendered.
+	*/
+	[[ nodiscard ]] bool finished () const { return ! m_hasRecord && m_outputPos == m_output.size (); }
+
+	/**
+	* Get the number of reads which returned a different value than in the recording.
+	* A tune reading back oscillator 3 or envelope 3 would have played differently
+	* on the chips as configured here.
+	*/
+	[[ nodiscard ]] uint32_t getReadMismatches () const { return m_readMismatches; }
+
+	[[ nodiscard ]] int getNumChips () const { return m_mixer.getNumChips (); }
+
+	/**
+	* The chip settings as in #Player, applied to all chips in place of the recorded ones.
+	* Call after #load.
+	*/
+	void setChipModel ( SidConfig::sid_model_t model )	{	override ( SidTrace::setting_t::MODEL, uint8_t ( model ), 0.0 );	}
+
+	void setCombinedWaveforms ( reSIDfp::CombinedWaveforms cws, const float threshold )	{	override ( SidTrace::setting_t::COMBINEDWAVEFORMS, uint8_t ( cws ), threshold );	}
+
+	void set6581FilterCurve ( const double value )		{	override ( SidTrace::setting_t::FILTER6581CURVE, 0, value );	}
+	void set6581FilterRange ( const double value )		{	override ( SidTrace::setting_t::FILTER6581RANGE, 0, value );	}
+	void set6581FilterGain ( const double value )		{	override ( SidTrace::setting_t::FILTER6581GAIN, 0, value );		}
+	void set6581DigiVolume ( const double value )		{	override ( SidTrace::setting_t::FILTER6581DIGI, 0, value );		}
+
+	void set8580FilterCurve ( const double value )		{	override ( SidTrace::setting_t::FILTER8580CURVE, 0, value );	}
+
+	void setDacLeakage ( const double value )			{	override ( SidTrace::setting_t::DACLEAKAGE, 0, value );			}
+	void set6581VoiceDCDrift ( const double value )		{	override ( SidTrace::setting_t::VOICE6581DCDRIFT, 0, value );	}
+
+	[[ nodiscard ]] const char* error () const { return m_errorString.c_str (); }
+};
+
+}
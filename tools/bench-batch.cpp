@@ -0,0 +1,108 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/**
+* Time the BatchRenderer with 1, 2, 4... workers up to one per core,
+* rendering every subtune of the tunes given, and report how it scales.
+*
+*   bench-batch <seconds per subtune> <tune.sid...>
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "EZ/batch-renderer.h"
+
+using namespace libsidplayEZ;
+
+int main ( int argc, char* argv[] )
+{
+	if ( argc < 3 )
+	{
+		std::printf ( "bench-batch <seconds per subtune> <tune.sid...>\n" );
+		return 1;
+	}
+
+	const auto	seconds = std::atoi ( argv[ 1 ] );
+
+	// Every subtune of every file
+	std::vector<BatchRenderer::job_t>	jobs;
+
+	for ( auto i = 2; i < argc; i++ )
+	{
+		SidTune	tune ( argv[ i ] );
+		if ( ! tune.getStatus () )
+		{
+			std::printf ( "%s: %s\n", argv[ i ], tune.statusString () );
+			continue;
+		}
+
+		for ( auto song = 1u; song <= tune.getInfo ()->songs (); song++ )
+		{
+			BatchRenderer::job_t	job;
+			job.filename = argv[ i ];
+			job.song = song;
+			job.durationMs = uint32_t ( seconds * 1000 );
+
+			jobs.push_back ( job );
+		}
+	}
+
+	const auto	cores = std::max ( std::thread::hardware_concurrency (), 1u );
+
+	std::printf ( "%zu subtunes of %d s, %u cores\n", jobs.size (), seconds, cores );
+
+	auto	single = 0.0;
+
+	for ( auto workers = 1u; ; workers = std::min ( workers * 2, cores ) )
+	{
+		std::atomic<unsigned>	failed = 0;
+
+		const auto	start = std::chrono::steady_clock::now ();
+		{
+			BatchRenderer	renderer ( {}, [ &failed ] ( BatchRenderer::result_t&& result )
+			{
+				if ( result.status != BatchRenderer::status_t::DONE )
+					failed++;
+			}, workers );
+
+			for ( const auto& job : jobs )
+				renderer.submit ( job );
+
+			renderer.wait ();
+		}
+		const auto	elapsed = std::chrono::duration<double> ( std::chrono::steady_clock::now () - start ).count ();
+
+		if ( workers == 1 )
+			single = elapsed;
+
+		std::printf ( "%3u workers %8.2f s %8.1fx realtime  speedup %5.2f  efficiency %3.0f%%  failed %u\n", workers, elapsed,
+			double ( jobs.size () ) * seconds / elapsed, single / elapsed, 100.0 * single / elapsed / workers, failed.load () );
+
+		if ( workers == cores )
+			break;
+	}
+
+	return 0;
+}
+//-----------------------------------------------------------------------------
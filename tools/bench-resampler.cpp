@@ -0,0 +1,164 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/**
+* Time the resamplers of each sampling method with each convolution kernel
+* the CPU supports, and check that all kernels give the same output.
+*
+*   bench-resampler [sample rate] [seconds]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "sidplayfp/residfp/resample/BlockResampler.h"
+#include "sidplayfp/residfp/resample/TwoPassSincResampler.h"
+#include "sidplayfp/residfp/resample/ZeroOrderResampler.h"
+
+using namespace reSIDfp;
+
+struct result_t
+{
+	double		ns;
+	unsigned	outputs;
+	uint64_t	checksum;
+};
+//-----------------------------------------------------------------------------
+
+// Resamplers taking one cycle sample at a time
+template<class T>
+static result_t runCycles ( T& resampler, const std::vector<int>& input )
+{
+	result_t	result = { 0.0, 0, 1469598103934665603ull };
+
+	const auto	start = std::chrono::steady_clock::now ();
+
+	for ( const auto v : input )
+	{
+		if ( resampler.input ( v ) )
+		{
+			result.checksum = ( result.checksum ^ uint16_t ( resampler.output ( 3 ) ) ) * 1099511628211ull;
+			result.outputs++;
+		}
+	}
+
+	result.ns = std::chrono::duration<double, std::nano> ( std::chrono::steady_clock::now () - start ).count ();
+	return result;
+}
+//-----------------------------------------------------------------------------
+
+static result_t runBlocks ( BlockResampler& resampler, const std::vector<int>& input )
+{
+	result_t	result = { 0.0, 0, 1469598103934665603ull };
+	int16_t		buffer[ BlockResampler::BLOCKSIZE ];
+
+	const auto	start = std::chrono::steady_clock::now ();
+
+	for ( auto pos = size_t ( 0 ); pos < input.size (); pos += BlockResampler::BLOCKSIZE )
+	{
+		const auto	count = int ( std::min ( input.size () - pos, size_t ( BlockResampler::BLOCKSIZE ) ) );
+
+		std::copy_n ( input.data () + pos, count, resampler.input () );
+
+		const auto	n = resampler.process ( count, buffer, 3 );
+
+		for ( auto i = 0; i < n; i++ )
+			result.checksum = ( result.checksum ^ uint16_t ( buffer[ i ] ) ) * 1099511628211ull;
+
+		result.outputs += unsigned ( n );
+	}
+
+	result.ns = std::chrono::duration<double, std::nano> ( std::chrono::steady_clock::now () - start ).count ();
+	return result;
+}
+//-----------------------------------------------------------------------------
+
+int main ( int argc, char* argv[] )
+{
+	constexpr auto	CLOCK = 985248.0;
+
+	const auto	sampleRate = argc > 1 ? std::atof ( argv[ 1 ] ) : 44100.0;
+	const auto	seconds = argc > 2 ? std::atoi ( argv[ 2 ] ) : 10;
+
+	// Noise in the range of the chip output
+	std::vector<int>	input ( size_t ( CLOCK ) * size_t ( seconds ) );
+	{
+		std::default_random_engine				re;
+		std::uniform_int_distribution<int>		unif ( -24000, 32000 );
+
+		for ( auto& v : input )
+			v = unif ( re );
+	}
+
+	std::printf ( "%.0f Hz, %d s of input\n", sampleRate, seconds );
+
+	auto	report = [] ( const char* isa, const char* name, const result_t& result )
+	{
+		std::printf ( "%-8s %-12s %8.1f ns/sample %7.2fM samples/s  checksum %016llx\n", isa, name,
+			result.ns / result.outputs, result.outputs / result.ns * 1e3, (unsigned long long)result.checksum );
+	};
+
+	// No convolutions
+	{
+		ZeroOrderResampler	resampler;
+		resampler.setup ( CLOCK, sampleRate );
+
+		report ( "", "interpolate", runCycles ( resampler, input ) );
+	}
+
+	for ( auto i = 0; i < int ( Convolution::isa_t::COUNT ); i++ )
+	{
+		const auto	isa = Convolution::isa_t ( i );
+		const auto	name = Convolution::getName ( isa );
+
+		if ( ! Convolution::select ( isa ) )
+		{
+			std::printf ( "%-8s not supported\n", name );
+			continue;
+		}
+
+		// All pick up the kernel on setup
+		{
+			auto	resampler = std::make_unique<BlockResampler> ();
+			resampler->setup ( CLOCK, sampleRate, 8 );
+
+			report ( name, "fast", runBlocks ( *resampler, input ) );
+		}
+
+		{
+			auto	resampler = std::make_unique<BlockResampler> ();
+			resampler->setup ( CLOCK, sampleRate );
+
+			report ( name, "block", runBlocks ( *resampler, input ) );
+		}
+
+		{
+			auto	resampler = std::make_unique<TwoPassSincResampler> ();
+			resampler->setup ( CLOCK, sampleRate );
+
+			report ( name, "two-pass", runCycles ( *resampler, input ) );
+		}
+	}
+
+	return 0;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,180 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/**
+* Time the EventScheduler on a synthetic load shaped like a C64, then the
+* rendering of the tunes given, multi-SID CIA timed ones being the heaviest.
+*
+* The queue is picked at build time, so build the library and this tool
+* once as they are for the chain and once with EVENTSCHEDULER_TIMING_WHEEL
+* defined for the timing wheel, and compare the two runs.
+*
+*   bench-scheduler [million events] [seconds per tune] [tune.sid...]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "EventScheduler.h"
+#include "EZ/player.h"
+
+using namespace libsidplayfp;
+
+//-----------------------------------------------------------------------------
+
+// Reschedules itself every period, like the VIC, the CIA timers and TODs do
+class Periodic final : public Event
+{
+	EventScheduler&	scheduler;
+	unsigned int	period;
+	event_phase_t	phase;
+
+public:
+	Periodic ( EventScheduler& _scheduler, unsigned int _period, event_phase_t _phase )
+		: Event ( "Periodic" ), scheduler ( _scheduler ), period ( _period ), phase ( _phase ) {}
+
+	void start () { scheduler.schedule ( *this, period, phase ); }
+	void event () override { scheduler.schedule ( *this, period, phase ); }
+};
+//-----------------------------------------------------------------------------
+
+// Fired by the CPU a few cycles after it was last rescheduled, like an interrupt
+class Interrupt final : public Event
+{
+public:
+	Interrupt () : Event ( "Interrupt" ) {}
+
+	void event () override {}
+};
+//-----------------------------------------------------------------------------
+
+// Every cycle at PHI2, cancelling and rescheduling the interrupt now and then
+class Cpu final : public Event
+{
+	EventScheduler&	scheduler;
+	Interrupt&		interrupt;
+	unsigned int	count = 0;
+
+public:
+	Cpu ( EventScheduler& _scheduler, Interrupt& _interrupt ) : Event ( "CPU" ), scheduler ( _scheduler ), interrupt ( _interrupt ) {}
+
+	void event () override
+	{
+		if ( ++count % 7 == 0 )
+		{
+			scheduler.cancel ( interrupt );
+			scheduler.schedule ( interrupt, 2, EVENT_CLOCK_PHI1 );
+		}
+
+		scheduler.schedule ( *this, 1 );
+	}
+};
+//-----------------------------------------------------------------------------
+
+static void benchQueue ( uint64_t events )
+{
+	EventScheduler	scheduler;
+	scheduler.reset ();
+
+	Interrupt	interrupt;
+	Cpu			cpu ( scheduler, interrupt );
+
+	// VIC raster line, CIA timers, TODs at 1/10 s, serial port, NMI source
+	Periodic	periodic[] = {
+		{ scheduler, 63, EVENT_CLOCK_PHI1 },
+		{ scheduler, 4926, EVENT_CLOCK_PHI1 },
+		{ scheduler, 19656, EVENT_CLOCK_PHI1 },
+		{ scheduler, 98525, EVENT_CLOCK_PHI1 },
+		{ scheduler, 98526, EVENT_CLOCK_PHI1 },
+		{ scheduler, 16, EVENT_CLOCK_PHI1 },
+		{ scheduler, 1000, EVENT_CLOCK_PHI2 },
+	};
+
+	for ( auto& p : periodic )
+		p.start ();
+
+	scheduler.schedule ( cpu, 0, EVENT_CLOCK_PHI2 );
+
+	constexpr auto	CHUNK = 1000000u;
+
+	const auto	start = std::chrono::steady_clock::now ();
+
+	for ( auto done = uint64_t ( 0 ); done < events; done += CHUNK )
+		scheduler.run ( CHUNK );
+
+	const auto	ns = std::chrono::duration<double, std::nano> ( std::chrono::steady_clock::now () - start ).count ();
+
+	std::printf ( "queue      %6.2f ns/event  %llu events, %.2f s\n", ns / double ( events ), (unsigned long long)events, ns * 1e-9 );
+}
+//-----------------------------------------------------------------------------
+
+static void benchTune ( const char* filename, int seconds )
+{
+	constexpr auto	SAMPLERATE = 44100;
+
+	libsidplayEZ::Player	player;
+	player.setRoms ( nullptr, nullptr, nullptr );
+	player.setSamplerate ( SAMPLERATE );
+
+	if ( ! player.loadSidFile ( filename ) || ! player.setTuneNumber () )
+	{
+		std::printf ( "%s: %s\n", filename, player.error () );
+		return;
+	}
+
+	const auto	cpuFreq = std::strcmp ( player.getFileInfo ().clock.c_str (), "NTSC" ) ? 985248.0 : 1022730.0;
+
+	std::vector<int16_t>	buffer ( SAMPLERATE / 10 * player.getNumOutChannels () );
+
+	const auto	startMs = player.getEmulatedTimeMs ();
+	const auto	start = std::chrono::steady_clock::now ();
+
+	for ( auto i = 0; i < seconds * 10; i++ )
+		if ( ! player.runEmulation ( buffer.data (), uint32_t ( buffer.size () ) ) )
+			break;
+
+	const auto	elapsed = std::chrono::duration<double> ( std::chrono::steady_clock::now () - start ).count ();
+	const auto	emulated = ( player.getEmulatedTimeMs () - startMs ) / 1000.0;
+
+	std::printf ( "%d SID %s  %7.2fM cycles/s  %6.1fx realtime  %s\n", player.getNumChips (), player.getFileInfo ().speed.c_str (),
+		emulated * cpuFreq / elapsed * 1e-6, emulated / elapsed, filename );
+}
+//-----------------------------------------------------------------------------
+
+int main ( int argc, char* argv[] )
+{
+	const auto	events = uint64_t ( argc > 1 ? std::atoi ( argv[ 1 ] ) : 200 ) * 1000000u;
+	const auto	seconds = argc > 2 ? std::atoi ( argv[ 2 ] ) : 30;
+
+#ifdef EVENTSCHEDULER_TIMING_WHEEL
+	std::printf ( "timing wheel\n" );
+#else
+	std::printf ( "chain\n" );
+#endif
+
+	benchQueue ( events );
+
+	for ( auto i = 3; i < argc; i++ )
+		benchTune ( argv[ i ], seconds );
+
+	return 0;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,246 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/**
+* Generate the filter model tables for linking into the library built with
+* RESIDFP_EMBEDDED_TABLES defined, so they are in its read-only data
+* and cost nothing at startup.
+*
+* Build against the library without RESIDFP_EMBEDDED_TABLES, on the platform
+* the tables are meant for, as they depend on its standard library and byte order:
+*
+*   gentables src/sidplayfp/residfp/EmbeddedTables.cpp
+*
+* The tables, about 11 MB per model, are written as binary files next to the
+* source file, named after it, which pulls them in with #embed where the compiler
+* has it, else with the .incbin directive of the GNU assembler. It compiles as
+* fast as any other small file.
+*
+*   gentables --hex src/sidplayfp/residfp/EmbeddedTables.cpp
+*
+* writes the tables into the source file as hex literals instead, for compilers
+* with neither, like MSVC. That's about 27 MB of source per model, which takes
+* GCC some seconds and half a GB of memory to compile.
+*
+* Run it again whenever the model constants change, else the library falls
+* back to building the tables at runtime.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "sidplayfp/residfp/FilterModelConfig6581.h"
+#include "sidplayfp/residfp/FilterModelConfig8580.h"
+#include "sidplayfp/residfp/TableCache.h"
+
+constexpr size_t	HEADER_SIZE = 64;
+
+//-----------------------------------------------------------------------------
+
+static bool readTables ( const std::filesystem::path& filename, uint64_t& format, uint64_t& hash, std::vector<uint8_t>& data )
+{
+	std::ifstream	in ( filename, std::ios::in | std::ios::binary );
+	if ( ! in )
+		return false;
+
+	const std::vector<uint8_t>	file ( ( std::istreambuf_iterator<char> ( in ) ), std::istreambuf_iterator<char> () );
+	if ( file.size () < HEADER_SIZE )
+		return false;
+
+	// Magic, format, hash, size
+	uint64_t	size;
+	std::memcpy ( &format, file.data () + 8, sizeof ( format ) );
+	std::memcpy ( &hash, file.data () + 16, sizeof ( hash ) );
+	std::memcpy ( &size, file.data () + 24, sizeof ( size ) );
+
+	if ( file.size () != HEADER_SIZE + size )
+		return false;
+
+	data.assign ( file.begin () + HEADER_SIZE, file.end () );
+	return true;
+}
+//-----------------------------------------------------------------------------
+
+static bool writeBlob ( const std::filesystem::path& filename, const std::vector<uint8_t>& data )
+{
+	std::ofstream	out ( filename, std::ios::out | std::ios::binary | std::ios::trunc );
+	out.write ( reinterpret_cast<const char*> ( data.data () ), std::streamsize ( data.size () ) );
+
+	return bool ( out );
+}
+//-----------------------------------------------------------------------------
+
+// As 64 bit words, so the tables keep their alignment
+static void writeHex ( FILE* out, const char* name, const std::vector<uint8_t>& data )
+{
+	std::fprintf ( out, "alignas ( 64 ) static const uint64_t	tables%s[] =\n{\n", name );
+
+	for ( auto pos = size_t ( 0 ); pos < data.size (); pos += 8 )
+	{
+		uint64_t	word;
+		std::memcpy ( &word, data.data () + pos, sizeof ( word ) );
+
+		const auto	column = ( pos / 8 ) % 8;
+
+		std::fprintf ( out, "%s0x%016llx,%s", column == 0 ? "\t" : " ", (unsigned long long)word, column == 7 ? "\n" : "" );
+	}
+
+	if ( ( data.size () / 8 ) % 8 )
+		std::fprintf ( out, "\n" );
+
+	std::fprintf ( out, "};\n\n" );
+}
+//-----------------------------------------------------------------------------
+
+static void writeEmbed ( FILE* out, const char* name, const std::filesystem::path& blob )
+{
+	// The assembler resolves relative paths against the working directory of the build, not the source file
+	auto	incbin = std::filesystem::absolute ( blob ).generic_string ();
+
+	for ( auto pos = incbin.find ( '"' ); pos != std::string::npos; pos = incbin.find ( '"', pos + 2 ) )
+		incbin.insert ( pos, "\\" );
+
+	std::fprintf ( out, "#if EMBED_TABLES\n" );
+	std::fprintf ( out, "alignas ( 64 ) static const unsigned char	tables%s[] =\n{\n", name );
+	std::fprintf ( out, "\t#embed \"%s\"\n", blob.filename ().generic_string ().c_str () );
+	std::fprintf ( out, "};\n" );
+	std::fprintf ( out, "#else\n" );
+	std::fprintf ( out, "extern \"C\" const unsigned char	tables%s[] asm ( \"reSIDfp_tables%s\" );\n\n", name, name );
+	std::fprintf ( out, "asm (\n" );
+	std::fprintf ( out, "\tTABLES_SECTION \"\\n\"\n" );
+	std::fprintf ( out, "\t\".balign 64\\n\"\n" );
+	std::fprintf ( out, "\t\"reSIDfp_tables%s:\\n\"\n", name );
+	std::fprintf ( out, "\t\".incbin \\\"%s\\\"\\n\"\n", incbin.c_str () );
+	std::fprintf ( out, "\t\".previous\\n\"\n" );
+	std::fprintf ( out, ");\n" );
+	std::fprintf ( out, "#endif\n\n" );
+}
+//-----------------------------------------------------------------------------
+
+int main ( int argc, char* argv[] )
+{
+	const auto	hex = argc == 3 && std::strcmp ( argv[ 1 ], "--hex" ) == 0;
+
+	if ( argc != 2 && ! hex )
+	{
+		std::fprintf ( stderr, "Usage: gentables [--hex] <output.cpp>\n" );
+		return 1;
+	}
+
+	const std::filesystem::path	output = argv[ argc - 1 ];
+
+	// Let the models write their tables as cache files
+	const auto	directory = std::filesystem::temp_directory_path () / "reSIDfp-gentables";
+
+	std::error_code	ec;
+	std::filesystem::remove_all ( directory, ec );
+
+	reSIDfp::TableCache::setDirectory ( directory.string () );
+
+	(void)reSIDfp::FilterModelConfig6581::getInstance ();
+	(void)reSIDfp::FilterModelConfig8580::getInstance ();
+
+	auto	out = std::fopen ( output.string ().c_str (), "w" );
+	if ( ! out )
+	{
+		std::fprintf ( stderr, "Can't write %s\n", output.string ().c_str () );
+		return 1;
+	}
+
+	std::fprintf ( out, "// Generated by tools/gentables.cpp, do not edit\n\n" );
+	std::fprintf ( out, "#include \"TableCache.h\"\n\n" );
+
+	if ( ! hex )
+	{
+		std::fprintf ( out, "#if defined __has_embed\n" );
+		std::fprintf ( out, "\t#define EMBED_TABLES	1\n" );
+		std::fprintf ( out, "#elif defined __GNUC__\n" );
+		std::fprintf ( out, "\t#define EMBED_TABLES	0\n\n" );
+		std::fprintf ( out, "\t#if defined __APPLE__\n" );
+		std::fprintf ( out, "\t\t#define TABLES_SECTION	\".const\"\n" );
+		std::fprintf ( out, "\t#elif defined _WIN32\n" );
+		std::fprintf ( out, "\t\t#define TABLES_SECTION	\".section .rdata,\\\"dr\\\"\"\n" );
+		std::fprintf ( out, "\t#else\n" );
+		std::fprintf ( out, "\t\t#define TABLES_SECTION	\".section .rodata\"\n" );
+		std::fprintf ( out, "\t#endif\n" );
+		std::fprintf ( out, "#else\n" );
+		std::fprintf ( out, "\t#error \"Neither #embed nor .incbin, generate the tables with gentables --hex\"\n" );
+		std::fprintf ( out, "#endif\n\n" );
+	}
+
+	std::fprintf ( out, "namespace reSIDfp\n{\n\n" );
+
+	const char*	names[] = { "6581", "8580" };
+
+	uint64_t	formats[ 2 ], hashes[ 2 ], sizes[ 2 ];
+
+	auto fail = [ & ] ( const std::string& message )
+	{
+		std::fprintf ( stderr, "%s\n", message.c_str () );
+		std::fclose ( out );
+		std::filesystem::remove ( output, ec );
+		return 1;
+	};
+
+	for ( auto i = 0; i < 2; i++ )
+	{
+		std::vector<uint8_t>	data;
+
+		// A library with the tables embedded already uses them instead of writing them out
+		if ( ! readTables ( directory / ( std::string ( "reSIDfp-" ) + names[ i ] + ".tables" ), formats[ i ], hashes[ i ], data ) )
+			return fail ( std::string ( "No tables for the " ) + names[ i ] + ", build gentables against the library without RESIDFP_EMBEDDED_TABLES." );
+
+		sizes[ i ] = data.size ();
+
+		// The padding is never read
+		data.resize ( ( data.size () + 7 ) & ~size_t ( 7 ) );
+
+		if ( hex )
+		{
+			writeHex ( out, names[ i ], data );
+			continue;
+		}
+
+		auto	blob = output;
+		blob.replace_filename ( output.stem ().string () + "-" + names[ i ] + ".bin" );
+
+		if ( ! writeBlob ( blob, data ) )
+			return fail ( "Can't write " + blob.string () );
+
+		writeEmbed ( out, names[ i ], blob );
+	}
+
+	std::fprintf ( out, "const TableCache::embedded_t	TableCache::embedded[] =\n{\n" );
+
+	for ( auto i = 0; i < 2; i++ )
+		std::fprintf ( out, "\t{ \"%s\", %llu, 0x%016llxull, %llu, tables%s },\n", names[ i ], (unsigned long long)formats[ i ], (unsigned long long)hashes[ i ], (unsigned long long)sizes[ i ], names[ i ] );
+
+	std::fprintf ( out, "\t{ nullptr, 0, 0, 0, nullptr },\n};\n\n" );
+	std::fprintf ( out, "} // namespace reSIDfp\n" );
+
+	std::fclose ( out );
+	std::filesystem::remove_all ( directory, ec );
+
+	return 0;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,128 @@
+/*
+* This file is part of libsidplayfp, a SID player engine.
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/**
+* Render a tune with the SID writes captured, replay the trace without the C64
+* and compare the output, for each sampling method. The replay must be bit-exact,
+* also across a seek forwards and one backwards in the middle of the render.
+* Returns 1 if any sample differs.
+*
+*   test-trace <tune.sid> [song] [seconds]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "EZ/player.h"
+#include "tracerenderer.h"
+
+using namespace libsidplayEZ;
+
+constexpr auto	SAMPLERATE = 48000;
+
+int main ( int argc, char* argv[] )
+{
+	if ( argc < 2 )
+	{
+		std::printf ( "test-trace <tune.sid> [song] [seconds]\n" );
+		return 1;
+	}
+
+	const auto	song = argc > 2 ? unsigned ( std::atoi ( argv[ 2 ] ) ) : 0u;
+	const auto	seconds = argc > 3 ? std::atoi ( argv[ 3 ] ) : 10;
+
+	const SidConfig::sampling_method_t	methods[] = { SidConfig::INTERPOLATE, SidConfig::RESAMPLE_FAST, SidConfig::RESAMPLE_BLOCK, SidConfig::RESAMPLE };
+	const char*							names[] = { "interpolate", "fast", "block", "two-pass" };
+
+	auto	failed = false;
+
+	for ( auto m = 0; m < int ( std::size ( methods ) ); m++ )
+	{
+		for ( const auto seek : { false, true } )
+		{
+			libsidplayfp::SidTrace	trace;
+
+			Player	player;
+			player.setRoms ( nullptr, nullptr, nullptr );
+			player.setSamplerate ( SAMPLERATE );
+			player.setSamplingMethod ( methods[ m ] );
+			player.setSidTrace ( &trace );
+
+			if ( ! player.loadSidFile ( argv[ 1 ] ) || ! player.setTuneNumber ( song ) )
+			{
+				std::printf ( "%s: %s\n", argv[ 1 ], player.error () );
+				return 1;
+			}
+
+			const auto	channels = player.getNumOutChannels ();
+
+			// Odd sized calls, so the resampler phase and the samples held back vary
+			std::vector<int16_t>	live;
+			std::vector<int16_t>	buffer ( 1237 * channels );
+
+			for ( auto second = 0; second < seconds; second++ )
+			{
+				if ( seek && second == seconds / 3 )
+					player.seekMs ( uint32_t ( second * 1000 + 2500 ) );
+
+				if ( seek && second == 2 * seconds / 3 )
+					player.seekMs ( 700 );
+
+				for ( auto left = SAMPLERATE * channels; left > 0; )
+				{
+					const auto	count = player.runEmulation ( buffer.data (), uint32_t ( std::min ( int ( buffer.size () ), left ) ) );
+					if ( ! count )
+						break;
+
+					live.insert ( live.end (), buffer.begin (), buffer.begin () + count );
+					left -= int ( count );
+				}
+			}
+
+			player.setSidTrace ( nullptr );
+
+			libsidplayfp::TraceRenderer	renderer;
+			if ( ! renderer.load ( trace.getData (), SAMPLERATE, channels == 2 ) )
+			{
+				std::printf ( "%s: %s\n", names[ m ], renderer.error () );
+				return 1;
+			}
+
+			std::vector<int16_t>	replayed ( live.size () + buffer.size () );
+			replayed.resize ( renderer.render ( replayed.data (), uint32_t ( replayed.size () ) ) );
+
+			auto	first = size_t ( 0 );
+			while ( first < std::min ( live.size (), replayed.size () ) && live[ first ] == replayed[ first ] )
+				first++;
+
+			const auto	same = first == live.size () && first == replayed.size ();
+
+			std::printf ( "%-12s %-8s %8zu samples, trace %8zu bytes  %s", names[ m ], seek ? "seeking" : "straight",
+				live.size (), trace.getData ().size (), same ? "identical\n" : "DIFFERENT" );
+
+			if ( ! same )
+				std::printf ( " from sample %zu, replayed %zu\n", first, replayed.size () );
+
+			failed |= ! same;
+		}
+	}
+
+	return failed ? 1 : 0;
+}
+//-----------------------------------------------------------------------------